@@ -37,8 +37,17 @@ SOURCES += main.cpp\
     LevelTrigger.cpp \
     PhysicsEntity.cpp \
     Player.cpp \
-    Particle.cpp \
     MovingPlatform.cpp \
+    SpatialGrid.cpp \
+    StaticCollisionTree.cpp \
+    ContactEventQueue.cpp \
+    TimerWheel.cpp \
+    TickRegistry.cpp \
+    WorkStealingPool.cpp \
+    ParticleEmitter.cpp \
+    ParticleKernels.cpp \
+    EffectPool.cpp \
+    FastRandom.cpp \
 
 HEADERS  += mainfrm.h \
     gamescene.h \
@@ -58,8 +67,17 @@ HEADERS  += mainfrm.h \
     LevelTrigger.h \
     PhysicsEntity.h \
     Player.h \
-    Particle.h \
     MovingPlatform.h \
+    SpatialGrid.h \
+    StaticCollisionTree.h \
+    ContactEventQueue.h \
+    TimerWheel.h \
+    TickRegistry.h \
+    WorkStealingPool.h \
+    ParticleEmitter.h \
+    ParticleKernels.h \
+    EffectPool.h \
+    FastRandom.h \
 
 
 FORMS    += mainfrm.ui
@@ -5,10 +5,19 @@
 #include "AdvancedCollisionSprite.h"
 
 #include "GameScene.h"
+#include "PhysicsEntity.h"
 
-AdvancedCollisionSprite::AdvancedCollisionSprite(QGraphicsItem* pParent) : Sprite(pParent) {}
-AdvancedCollisionSprite::AdvancedCollisionSprite(const QString& rImagePath, QGraphicsItem* pParent) : Sprite(rImagePath, pParent) {}
+#include <QDebug>
+#include <QHash>
+
+AdvancedCollisionSprite::AdvancedCollisionSprite(QGraphicsItem* pParent) : Sprite(pParent) {
+    addCapability(AdvancedCollisionCapability);
+}
+AdvancedCollisionSprite::AdvancedCollisionSprite(const QString& rImagePath, QGraphicsItem* pParent) : Sprite(rImagePath, pParent) {
+    addCapability(AdvancedCollisionCapability);
+}
 AdvancedCollisionSprite::AdvancedCollisionSprite(const QString& rImagePath, QRectF collisionOverride, QGraphicsItem* pParent) : Sprite(rImagePath, pParent) {
+    addCapability(AdvancedCollisionCapability);
     setCollisionOverride(collisionOverride);
 }
 
@@ -17,29 +26,41 @@ AdvancedCollisionSprite::AdvancedCollisionSprite(const QString& rImagePath, QRec
 //! \param rect The rect to use as the new collision override.
 void AdvancedCollisionSprite::setCollisionOverride(QRectF rect) {
     collisionOverrideRect = rect;
+    m_isCollisionRectValid = false;
 }
 
 //! Removes the collision override.
 void AdvancedCollisionSprite::removeCollisionOverride() {
     collisionOverrideRect = QRectF();
+    m_isCollisionRectValid = false;
 }
 
 //! Returns the collision rect.
+//! The collision rect is cached, and only computed again when the scene bounding rect
+//! of the sprite (itself cached until the sprite moves or is transformed) or the collision override changes.
 //! \return The collision rect. If the collision override is empty, returns the scene bounding rect.
 QRectF AdvancedCollisionSprite::collisionRect() const {
+    QRectF boundingRect = globalBoundingRect();
+    if (m_isCollisionRectValid && boundingRect == m_collisionRectSource) { // If the sprite didn't move
+        return m_collisionRect;
+    }
+
     if (collisionOverrideRect.isEmpty()) { // If the collision override is empty
-        return sceneBoundingRect();
+        m_collisionRect = boundingRect;
     } else {
         // Base the collision rect on the collision override
-        QRectF collisionRect = QRectF(0, 0 , collisionOverrideRect.width(), collisionOverrideRect.height());
+        m_collisionRect = QRectF(0, 0 , collisionOverrideRect.width(), collisionOverrideRect.height());
 
         // Center the collision rect on the sprite
-        collisionRect.moveCenter(sceneBoundingRect().center());
+        m_collisionRect.moveCenter(boundingRect.center());
 
         // Move the collision rect to the collision override position
-        collisionRect.translate(collisionOverrideRect.x(), collisionOverrideRect.y());
-        return collisionRect;
+        m_collisionRect.translate(collisionOverrideRect.x(), collisionOverrideRect.y());
     }
+
+    m_collisionRectSource = boundingRect;
+    m_isCollisionRectValid = true;
+    return m_collisionRect;
 }
 
 //! Get the collision rect of any sprite.
@@ -47,37 +68,69 @@ QRectF AdvancedCollisionSprite::collisionRect() const {
 //! \param pSprite The sprite to get the collision rect of.
 //! \return The collision rect of the sprite.
 QRectF AdvancedCollisionSprite::getCollisionRect(Sprite* pSprite) {
-    QRectF otherCollisionRect = pSprite->sceneBoundingRect();
-
-    auto* pAdvancedCollisionSprite = dynamic_cast<AdvancedCollisionSprite*>(pSprite);
+    auto* pAdvancedCollisionSprite = fromSprite(pSprite);
     if (pAdvancedCollisionSprite) { // If the sprite is an advanced collision sprite
         // Use the collision rect instead of the scene bounding rect
-        otherCollisionRect = pAdvancedCollisionSprite->collisionRect();
+        return pAdvancedCollisionSprite->collisionRect();
+    }
+    return pSprite->globalBoundingRect();
+}
+
+//! Casts a sprite to an AdvancedCollisionSprite, without RTTI.
+//! \param pSprite The sprite to cast.
+//! \return The sprite as an AdvancedCollisionSprite, or nullptr if it isn't one.
+AdvancedCollisionSprite* AdvancedCollisionSprite::fromSprite(Sprite* pSprite) {
+    if (pSprite == nullptr || !pSprite->hasCapability(AdvancedCollisionCapability)) {
+        return nullptr;
     }
-    return otherCollisionRect;
+    return static_cast<AdvancedCollisionSprite*>(pSprite);
 }
 
-//! Adds a tag to the colliding tags list.
-//! If the tag is "BlockAll", the list will be cleared and "BlockAll" will be added.
-//! If the list contains "BlockAll", it will be cleared and the tag will be added.
-//! \param tagName The tag name to add to the colliding tags list.
+//! Returns the collision layer of a tag name.
+//! The first time a tag name is seen, it is given the next free layer.
+//! The empty tag name is always the DEFAULT_LAYER.
+//! \param tagName The tag name.
+//! \return The collision layer of the tag name (a single bit).
+quint64 AdvancedCollisionSprite::layerOf(const QString& tagName) {
+    static QHash<QString, quint64> s_layers = {{"", DEFAULT_LAYER}};
+
+    auto it = s_layers.constFind(tagName);
+    if (it != s_layers.constEnd()) { // If the tag is already interned
+        return it.value();
+    }
+
+    if (s_layers.count() >= MAX_LAYER_COUNT) { // If there is no free layer left
+        qWarning() << "Too many collision tags, " << tagName << " uses the default layer";
+        return DEFAULT_LAYER;
+    }
+
+    quint64 layer = DEFAULT_LAYER << s_layers.count();
+    s_layers.insert(tagName, layer);
+    return layer;
+}
+
+//! Sets the collision tag of the sprite.
+//! The tag name is interned into its collision layer.
+//! \param tagName The new collision tag.
+void AdvancedCollisionSprite::setCollisionTag(const QString& tagName) {
+    m_collisionTag = tagName;
+    m_collisionLayer = layerOf(tagName);
+}
+
+//! Adds a tag to the collision mask.
+//! If the tag is "BlockAll", the sprite will collide with all layers.
+//! If the sprite collides with all layers, the mask will be cleared and the tag will be added.
+//! \param tagName The tag name to add to the collision mask.
 void AdvancedCollisionSprite::addCollidingTag(const QString &tagName) {
     if (tagName == "BlockAll") { // If the tag is "BlockAll"
         collideAll();
-    } else if (collidingTags.contains("All")) { // If the list contains "BlockAll"
-        collidingTags.clear();
-        collidingTags.append(tagName);
+    } else if (m_collisionMask == ALL_LAYERS) { // If the sprite collides with all layers
+        m_collisionMask = layerOf(tagName);
     } else {
-        collidingTags.append(tagName);
+        m_collisionMask |= layerOf(tagName);
     }
 }
 
-//! Sets the colliding tags list to contain only "BlockAll".
-void AdvancedCollisionSprite::collideAll() {
-    collidingTags.clear();
-    collidingTags.append("BlockAll");
-}
-
 //! Checks for intersections with other sprites.
 //! Uses the current collision rect if it is not empty.
 //! Else uses the current scene bounding rect.
@@ -102,54 +155,125 @@ void AdvancedCollisionSprite::reevaluateIntersects(QRectF rect) {
 }
 
 //! Returns a list of AdvancedCollisionSprites that the sprite is colliding with.
-//! Only returns AdvancedCollisionSprites that have the same collision tag as this sprite.
+//! Only returns AdvancedCollisionSprites whose collision layer is in the collision mask of this sprite.
 //! \param rect The rect to check for intersections with. If empty, uses the current scene bounding rect of the sprite.
 //! \return A list of AdvancedCollisionSprites that the sprite is colliding with.
 QList<AdvancedCollisionSprite*> AdvancedCollisionSprite::getCollidingSprites(QRectF rect) const {
-    auto collidingSprites = m_pParentScene->collidingSprites((rect.isEmpty()) ? collisionRect() : rect);
-    collidingSprites.removeAll(this);
+    auto candidateLists = queryCollisionCandidates({(rect.isEmpty()) ? collisionRect() : rect});
+    return filterCollidingSprites(candidateLists.first());
+}
 
-    QList<AdvancedCollisionSprite*> advCollidingSprites;
+//! Returns, for each of the given rects, a list of AdvancedCollisionSprites that the sprite is colliding with.
+//! The scene is only queried once, for all the rects.
+//! This is cheaper than calling getCollidingSprites once per rect when the rects are close to each other
+//! (for example a movement and a probe next to it).
+//! \param rects The rects to check for intersections with.
+//! \return A list of AdvancedCollisionSprites per rect, in the order of the given rects.
+QList<QList<AdvancedCollisionSprite*>> AdvancedCollisionSprite::getCollidingSprites(const QList<QRectF>& rects) const {
+    QList<QList<AdvancedCollisionSprite*>> advCollidingSpriteLists;
+    advCollidingSpriteLists.reserve(rects.size());
 
-    foreach (Sprite* pSprite, collidingSprites) { // For each colliding sprite
-        auto* pAdvancedCollisionSprite = dynamic_cast<AdvancedCollisionSprite*>(pSprite);
-        if (pAdvancedCollisionSprite) { // If the sprite is an advanced collision sprite
-            advCollidingSprites << pAdvancedCollisionSprite;
-        }
+    foreach (const QList<Sprite*>& candidates, queryCollisionCandidates(rects)) {
+        advCollidingSpriteLists << filterCollidingSprites(candidates);
     }
 
-    if (collidingTags.contains("BlockAll")) { // If the sprite collides with all sprites
-        return advCollidingSprites;
+    return advCollidingSpriteLists;
+}
+
+//! Queries the scene for the sprites intersecting each of the given rects, in a single pass.
+//! The candidates are not filtered yet. Use filterCollidingSprites to keep the ones the sprite collides with.
+//! \param rects The rects to check for intersections with.
+//! \return A list of candidate sprites per rect. Lists are empty if the sprite doesn't collide with anything.
+QList<QList<Sprite*>> AdvancedCollisionSprite::queryCollisionCandidates(const QList<QRectF>& rects) const {
+    if (m_collisionMask == NO_LAYERS) { // If the sprite doesn't collide with anything
+        return QList<QList<Sprite*>>(rects.size());
     }
 
-    // Remove sprites that are not in the colliding classes list
-    for (int i = 0; i < advCollidingSprites.size(); i++) {
-        auto* advSprite = dynamic_cast<AdvancedCollisionSprite*>(advCollidingSprites[i]);
-        if (!advSprite || !collidingTags.contains(collisionTag)) {
-            advCollidingSprites.removeAt(i);
+    // The scene uses the candidates of its broad phase when this sprite is part of it
+    return m_pParentScene->collidingSprites(rects, this);
+}
+
+//! Keeps the candidates the sprite collides with.
+//! Only keeps AdvancedCollisionSprites whose collision layer is in the collision mask of this sprite.
+//! Subclasses can override this function to ignore more sprites.
+//! \param candidates The candidate sprites, as returned by the scene.
+//! \return The AdvancedCollisionSprites that the sprite is colliding with.
+QList<AdvancedCollisionSprite*> AdvancedCollisionSprite::filterCollidingSprites(const QList<Sprite*>& candidates) const {
+    QList<AdvancedCollisionSprite*> advCollidingSprites;
+
+    foreach (Sprite* pSprite, candidates) { // For each candidate
+        auto* pAdvancedCollisionSprite = fromSprite(pSprite);
+        if (pAdvancedCollisionSprite && collidesWith(pAdvancedCollisionSprite)) { // If the sprite is an advanced collision sprite of a colliding layer
+            advCollidingSprites << pAdvancedCollisionSprite;
         }
     }
 
     return advCollidingSprites;
 }
 
-//! Called when the sprites intersects with another sprite as a trigger.
-//! Emits the notifyTrigger signal.
+//! Called when the sprites intersects with another sprite as a trigger, during the physics.
+//! Records the contact, which is notified once the tick is over (see onContact).
+//! Gameplay reactions belong in onContact, not in an override of this function.
 //! \param pOther The other sprite.
 void AdvancedCollisionSprite::onTrigger(AdvancedCollisionSprite* pOther) {
-    emit notifyTrigger(pOther);
+    recordContact(pOther, ContactEventQueue::TriggerContact);
 }
 
-//! Called when the sprites intersects with another sprite as a collision.
-//! Emits the notifyCollision signal.
+//! Called when the sprites intersects with another sprite as a collision, during the physics.
+//! Records the contact, which is notified once the tick is over (see onContact).
+//! Gameplay reactions belong in onContact, not in an override of this function.
 //! \param pOther The other sprite.
 void AdvancedCollisionSprite::onCollision(AdvancedCollisionSprite* pOther) {
-    emit notifyCollision(pOther);
+    recordContact(pOther, ContactEventQueue::CollisionContact);
 }
 
-//! Called when the sprite is stepped an physics entity.
-//! Emits the notifySteppedOn signal.
+//! Called when the sprite is stepped an physics entity, during the physics.
+//! Records the contact, which is notified once the tick is over (see onContact).
+//! Gameplay reactions belong in onContact, not in an override of this function.
 //! \param pEntity The physics entity that stepped on the sprite.
 void AdvancedCollisionSprite::onSteppedOn(PhysicsEntity* pEntity) {
-    emit notifySteppedOn(pEntity);
+    recordContact(pEntity, ContactEventQueue::SteppedOnContact);
+}
+
+//! Called once per tick for each contact of the sprite, after the physics of the tick.
+//! When a contact begins, emits the notifyContactBegin signal, along with the notifyTrigger,
+//! notifyCollision or notifySteppedOn signal matching the contact type.
+//! When a contact ends, emits the notifyContactEnd signal.
+//! Contacts that stay aren't notified.
+//! Override this function to react to the contacts, calling the parent function to keep the signals.
+//! \param pOther The other sprite of the contact.
+//! \param type The kind of intersection that caused the contact.
+//! \param phase Whether the contact begins, stays or ends.
+void AdvancedCollisionSprite::onContact(AdvancedCollisionSprite* pOther, ContactEventQueue::ContactType type,
+                                        ContactEventQueue::ContactPhase phase) {
+    switch (phase) {
+        case ContactEventQueue::ContactBegin:
+            switch (type) {
+                case ContactEventQueue::TriggerContact:
+                    emit notifyTrigger(pOther);
+                    break;
+                case ContactEventQueue::CollisionContact:
+                    emit notifyCollision(pOther);
+                    break;
+                case ContactEventQueue::SteppedOnContact:
+                    emit notifySteppedOn(static_cast<PhysicsEntity*>(pOther));
+                    break;
+            }
+            emit notifyContactBegin(pOther, type);
+            break;
+        case ContactEventQueue::ContactStay:
+            break;
+        case ContactEventQueue::ContactEnd:
+            emit notifyContactEnd(pOther, type);
+            break;
+    }
+}
+
+//! Records a contact with another sprite in the contact queue of the scene.
+//! \param pOther The other sprite.
+//! \param type The kind of intersection.
+void AdvancedCollisionSprite::recordContact(AdvancedCollisionSprite* pOther, ContactEventQueue::ContactType type) {
+    if (m_pParentScene) {
+        m_pParentScene->contactEventQueue().record(this, pOther, type);
+    }
 }
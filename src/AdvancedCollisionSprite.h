@@ -11,13 +11,14 @@
 class PhysicsEntity;
 
 #include "sprite.h"
+#include "ContactEventQueue.h"
 
 //! \brief A class that can be used to create advanced collisions
 //!
 //! This class is used to create advanced collisions.
 //! This is useful for creating walls and other objects that certain entities can collide with while ignoring others.
 //!
-//! When colliding with another sprite, the AdvancedCollisionSprite will emit a signal and call the onCollide function on itself.
+//! When colliding with another sprite, the AdvancedCollisionSprite will call the onCollision function on itself.
 //!
 //! By default the intersection rect is the scene bounding rect.
 //! This can be changed by using the setCollisionOverride function.
@@ -28,25 +29,36 @@ class PhysicsEntity;
 //! This class also allows the creation of triggers.
 //! A AdvancedCollisionSprite can be set to be a trigger with the setTrigger function.
 //! Triggers are a special type of collision that don't block other sprites from intersecting with them.
-//! When a sprite intersects with a trigger, the trigger will emit a signal and call the onTrigger function of the other sprite.
+//! When a sprite intersects with a trigger, the onTrigger function of the trigger is called with the other sprite.
 //! This allows for the creation of zones that can be used to trigger events.
 //! For example a trigger can be used to trigger a level transition when the player enters a certain area.
 //!
+//! Each AdvancedCollisionSprite has a collision tag, set with setCollisionTag.
+//! Tag names are interned into collision layers : every distinct tag name is given its own bit of a 64 bits layer.
+//! The empty tag is the DEFAULT_LAYER. Tags are only compared as strings once, when they are interned.
+//!
 //! The class allows the user to specify which AdvancedCollisionSprites it should collide with.
-//! This is done with the addCollidingTag and removeCollidingTag functions.
-//! A tag can be added with these functions, and then the AdvancedCollisionSprite will only collide with sprites that have the same tag.
-//! If no tags are in the list, the AdvancedCollisionSprite won't collide with any sprites (This is not recommended. Use a Sprite instead).
-//! If the list contains the string "All", the AdvancedCollisionSprite will collide with all other AdvancedCollisionSprite.
+//! This is done with the addCollidingTag and removeCollidingTag functions, which update the collision mask of the sprite.
+//! A tag can be added with these functions, and then the AdvancedCollisionSprite will only collide with sprites that have one of the added tags.
+//! If no tags are in the mask, the AdvancedCollisionSprite won't collide with any sprites (This is not recommended. Use a Sprite instead).
+//! This can be done with the collideNone function.
+//! By default, or when the tag "BlockAll" is added, the AdvancedCollisionSprite will collide with all other AdvancedCollisionSprite.
 //! This can be done with the collideAll function.
 //!
 //! The class also contains a function called getCollidingSprites.
 //! This function returns a list of all sprites that are colliding with the AdvancedCollisionSprite.
-//! This list only contains sprites that are of a tag that is in the collidingTags list.
+//! This list only contains sprites whose collision layer is in the collision mask : (mask & layer) != 0.
 //! If the list is empty, the AdvancedCollisionSprite is not colliding with any other AdvancedCollisionSprites.
+//! getCollidingSprites can also take several rects, in which case the scene is only queried once for all of them.
 //!
-//! The onTrigger and onCollide functions can be overridden to create custom behavior when a collision or trigger occurs.
-//! This is especially useful for creating custom triggers.
-//! This can also be done by connecting to the notifyTrigger and notifyCollision signals.
+//! The onTrigger, onCollision and onSteppedOn functions are called during the physics, on every tick of every contact.
+//! They only record the contact in the ContactEventQueue of the scene (and, for a PhysicsEntity, resolve the collision).
+//! The queue removes the duplicates and dispatches the contacts once the physics of the tick is over,
+//! by calling onContact with the transition of the contact (begin, stay or end).
+//! Custom behavior when a collision or trigger occurs (collecting, changing level, dying...) is created by overriding onContact,
+//! usually to react to ContactBegin. This is especially useful for creating custom triggers.
+//! This can also be done by connecting to the signals : the notifyTrigger, notifyCollision, notifySteppedOn
+//! and notifyContactBegin signals are emitted when a contact begins, and the notifyContactEnd signal when it ends.
 class AdvancedCollisionSprite : public Sprite {
 
     Q_OBJECT
@@ -60,18 +72,36 @@ public:
     inline void setTrigger(bool trigger) { isTrigger = trigger;};
     [[nodiscard]] inline bool getIsTrigger() const { return isTrigger; };
 
-    // Colliding tag
-    QString collisionTag = "";
+    // Collision layers
+    static constexpr quint64 NO_LAYERS = 0;
+    static constexpr quint64 DEFAULT_LAYER = 1;
+    static constexpr quint64 ALL_LAYERS = ~NO_LAYERS;
+    static constexpr int MAX_LAYER_COUNT = 64;
+    [[nodiscard]] static quint64 layerOf(const QString& tagName);
+
+    // Collision tag
+    void setCollisionTag(const QString& tagName);
+    [[nodiscard]] inline QString collisionTag() const { return m_collisionTag; }
+    [[nodiscard]] inline quint64 collisionLayer() const { return m_collisionLayer; }
+
+    // Colliding tags
     void addCollidingTag(const QString& tagName);
-    inline void removeCollidingTag(const QString& tagName) { collidingTags.removeOne(tagName); };
-    void collideAll();
+    inline void removeCollidingTag(const QString& tagName) { m_collisionMask &= ~layerOf(tagName); };
+    inline void collideAll() { m_collisionMask = ALL_LAYERS; };
+    inline void collideNone() { m_collisionMask = NO_LAYERS; };
+    inline void setCollisionMask(quint64 mask) { m_collisionMask = mask; };
+    [[nodiscard]] inline quint64 collisionMask() const { return m_collisionMask; }
+    [[nodiscard]] inline bool collidesWith(const AdvancedCollisionSprite* pOther) const { return (m_collisionMask & pOther->m_collisionLayer) != 0; }
 
-    [[nodiscard]] virtual QList<AdvancedCollisionSprite*> getCollidingSprites(QRectF rect) const;
+    [[nodiscard]] virtual QList<AdvancedCollisionSprite*> getCollidingSprites(QRectF rect = QRectF()) const;
+    [[nodiscard]] QList<QList<AdvancedCollisionSprite*>> getCollidingSprites(const QList<QRectF>& rects) const;
 
     // Intersection events
     virtual void onTrigger(AdvancedCollisionSprite* pOther);
     virtual void onCollision(AdvancedCollisionSprite* pOther);
     virtual void onSteppedOn(PhysicsEntity* pEntity);
+    virtual void onContact(AdvancedCollisionSprite* pOther, ContactEventQueue::ContactType type,
+                           ContactEventQueue::ContactPhase phase);
 
     // Intersections checks
     virtual void reevaluateIntersects();
@@ -79,6 +109,7 @@ public:
 
     [[nodiscard]] QRectF collisionRect() const;
     [[nodiscard]] static QRectF getCollisionRect(Sprite* sprite);
+    [[nodiscard]] static AdvancedCollisionSprite* fromSprite(Sprite* pSprite);
 
 protected:
     // Trigger
@@ -89,13 +120,30 @@ protected:
     void setCollisionOverride(QRectF rect);
     void removeCollisionOverride();
 
-    // Collision tags
-    QList<QString> collidingTags = {"BlockAll"};
+    // Contacts
+    void recordContact(AdvancedCollisionSprite* pOther, ContactEventQueue::ContactType type);
+
+    // Collision queries
+    [[nodiscard]] QList<QList<Sprite*>> queryCollisionCandidates(const QList<QRectF>& rects) const;
+    [[nodiscard]] virtual QList<AdvancedCollisionSprite*> filterCollidingSprites(const QList<Sprite*>& candidates) const;
+
+private:
+    // Collision tag and layers
+    QString m_collisionTag = "";
+    quint64 m_collisionLayer = DEFAULT_LAYER;
+    quint64 m_collisionMask = ALL_LAYERS;
+
+    // Cached collision rect, along with the scene bounding rect it was computed from
+    mutable QRectF m_collisionRect;
+    mutable QRectF m_collisionRectSource;
+    mutable bool m_isCollisionRectValid = false;
 
 signals:
     void notifyTrigger(Sprite* pOther);
     void notifyCollision(Sprite* pOther);
     void notifySteppedOn(PhysicsEntity* pEntity);
+    void notifyContactBegin(AdvancedCollisionSprite* pOther, ContactEventQueue::ContactType type);
+    void notifyContactEnd(AdvancedCollisionSprite* pOther, ContactEventQueue::ContactType type);
 };
 
 
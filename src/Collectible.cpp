@@ -5,7 +5,7 @@
 #include "gamescene.h"
 
 #include "Collectible.h"
-#include "Particle.h"
+#include "ParticleEmitter.h"
 #include "resources.h"
 #include "Player.h"
 
@@ -34,12 +34,17 @@ Collectible::Collectible(const QString &rImagePath, QRectF collisionOverride, un
     m_respawnTime = respawnTime;
 }
 
-//! Override of the onTrigger function from AdvancedCollisionSprite:
-//! When the collectible is intersecting with a player, the onCollect function is called.
-void Collectible::onTrigger(AdvancedCollisionSprite* pOther) {
-    AdvancedCollisionSprite::onTrigger(pOther);
+//! Override of the onContact function from AdvancedCollisionSprite:
+//! When a player starts intersecting with the collectible, the onCollect function is called.
+//! \param pOther The other sprite of the contact.
+//! \param type The kind of intersection that caused the contact.
+//! \param phase Whether the contact begins, stays or ends.
+void Collectible::onContact(AdvancedCollisionSprite* pOther, ContactEventQueue::ContactType type,
+                            ContactEventQueue::ContactPhase phase) {
+    AdvancedCollisionSprite::onContact(pOther, type, phase);
 
-    if (pOther->collisionTag == "Player" && isEnabled()) {
+    if (phase == ContactEventQueue::ContactBegin && type == ContactEventQueue::TriggerContact
+        && pOther->collisionLayer() == Player::PLAYER_LAYER && isEnabled()) {
         // Collectible was collected by player
         onCollect((Player*) pOther);
     }
@@ -49,8 +54,9 @@ void Collectible::onTrigger(AdvancedCollisionSprite* pOther) {
 //! Disables the collectible
 //! \param player The player that collected the collectible.
 void Collectible::onCollect(Player* player) {
-    disable();
+    // The particles are spawned first, as disable() may destroy the collectible
     spawnCollectParticles(player);
+    disable();
 }
 
 //! Disables the collectible and hides it.
@@ -66,7 +72,7 @@ void Collectible::disable() {
         delete this;
     } else {
         // Collectible is disabled and will reappear after a delay
-        QTimer::singleShot(5000, this, &Collectible::enable);
+        scheduleAfter(5000, [this]() { enable(); });
     }
 }
 
@@ -79,14 +85,14 @@ void Collectible::enable() {
 
 //! Spawn particles that travel towards the player.
 void Collectible::spawnCollectParticles(Player* pPlayer, int particleCount) {
-    for (int i = 1; i < particleCount; i++) {
-        auto* particle = new Particle(Particle::TRAVEL, GameFramework::imagesPath() + "particle.png");
-        particle->setPos(sceneBoundingRect().center());
-        particle->setScale(.1);
-        particle->setTravelTarget(pPlayer);
-        particle->initialSpeed = 7.5;
-        particle->setAcceleration(0.925f);
-        particle->fadeTime = .5f;
-        parentScene()->addSpriteToScene(particle);
-    }
+    static const QString PARTICLE_IMAGE_PATH = GameFramework::imagesPath() + "particle.png";
+
+    // The emitter is shared by all the collectibles of the scene : the modifiers are set before each burst
+    ParticleEmitter* pEmitter = parentScene()->effectPool().particleEmitter(PARTICLE_IMAGE_PATH);
+    pEmitter->particleScale = .1;
+    pEmitter->initialSpeed = 7.5;
+    pEmitter->acceleration = 0.925f;
+    pEmitter->fadeTime = .5f;
+    pEmitter->setTravelTarget(pPlayer);
+    pEmitter->spawnParticles(ParticleEmitter::TRAVEL, globalBoundingRect().center(), particleCount - 1);
 }
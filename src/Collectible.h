@@ -21,6 +21,9 @@ class Player;
 //! The collectible can be set to respawn after a certain amount of time.
 //! The collectible will be hidden and disabled when it is collected and will reappear after the specified amount of time.
 //! If the respawn time is set to 0, the collectible will not respawn but will be destroyed when collected.
+//!
+//! When collected, the collectible spawns particles that travel towards the player.
+//! They are simulated by the ParticleEmitter of the effect pool of the scene, shared by all the collectibles.
 class Collectible : public AdvancedCollisionSprite {
 
 protected:
@@ -30,7 +33,8 @@ protected:
 
     virtual void onCollect(Player* player);
 
-    void onTrigger(AdvancedCollisionSprite* pOther) override;
+    void onContact(AdvancedCollisionSprite* pOther, ContactEventQueue::ContactType type,
+                   ContactEventQueue::ContactPhase phase) override;
 
 private:
     unsigned int m_respawnTime = 0;
@@ -0,0 +1,75 @@
+//
+// Created by blatnoa on 08.06.2023.
+//
+
+#include "ContactEventQueue.h"
+
+#include "AdvancedCollisionSprite.h"
+
+//! Records a contact detected during the current tick.
+//! Recording the same contact several times during a tick has no effect.
+//! \param pReceiver The sprite that will be notified of the contact.
+//! \param pOther The other sprite of the contact.
+//! \param type The kind of intersection that caused the contact.
+void ContactEventQueue::record(AdvancedCollisionSprite* pReceiver, AdvancedCollisionSprite* pOther, ContactType type) {
+    m_currentContacts.insert({pReceiver, pOther, type});
+}
+
+//! Drops every contact involving the given sprite.
+//! Called when the sprite leaves the scene, so that no event is dispatched to or about it.
+//! Can be called while the events are being dispatched.
+//! \param pSprite The sprite that leaves the scene.
+void ContactEventQueue::remove(const Sprite* pSprite) {
+    auto involvesSprite = [pSprite](const Contact& rContact) { return rContact.involves(pSprite); };
+    m_currentContacts.removeIf(involvesSprite);
+    m_previousContacts.removeIf(involvesSprite);
+
+    // Events already waiting to be dispatched are only marked, as flush() may be iterating over them
+    for (Event& rEvent : m_pendingEvents) {
+        if (rEvent.contact.involves(pSprite)) {
+            rEvent.contact.pReceiver = nullptr;
+        }
+    }
+}
+
+//! Dispatches the contact transitions of the tick to their receivers.
+//! Must be called once per tick, after every contact of the tick was recorded.
+//! Contacts recorded while the events are dispatched belong to the next tick.
+void ContactEventQueue::flush() {
+    // Compare the contacts of this tick with the contacts of the previous tick
+    for (const Contact& rContact : m_currentContacts) {
+        m_pendingEvents << Event{rContact, m_previousContacts.contains(rContact) ? ContactStay : ContactBegin};
+    }
+    for (const Contact& rContact : m_previousContacts) {
+        if (!m_currentContacts.contains(rContact)) { // The contact wasn't recorded again
+            m_pendingEvents << Event{rContact, ContactEnd};
+        }
+    }
+
+    m_previousContacts.swap(m_currentContacts);
+    m_currentContacts.clear();
+
+    // Dispatch by index : the receivers may add or remove sprites while being notified
+    for (int i = 0; i < m_pendingEvents.size(); i++) {
+        Event event = m_pendingEvents.at(i);
+        if (event.contact.pReceiver == nullptr) { // One of the sprites left the scene
+            continue;
+        }
+        event.contact.pReceiver->onContact(event.contact.pOther, event.contact.type, event.phase);
+    }
+    m_pendingEvents.clear();
+}
+
+//! Drops every contact, without dispatching any event.
+void ContactEventQueue::clear() {
+    m_currentContacts.clear();
+    m_previousContacts.clear();
+    m_pendingEvents.clear();
+}
+
+//! Checks if the contact involves the given sprite.
+//! \param pSprite The sprite.
+//! \return True if the sprite is the receiver or the other sprite of the contact.
+bool ContactEventQueue::Contact::involves(const Sprite* pSprite) const {
+    return pReceiver == pSprite || pOther == pSprite;
+}
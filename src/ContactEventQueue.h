@@ -0,0 +1,86 @@
+/**
+\file     ContactEventQueue.h
+\brief    Déclaration de la classe ContactEventQueue.
+\author   Blattner Noah
+\date     juin 2023
+*/
+
+#ifndef INC_2023_JCO_AIRTIME_CONTACTEVENTQUEUE_H
+#define INC_2023_JCO_AIRTIME_CONTACTEVENTQUEUE_H
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+
+class AdvancedCollisionSprite;
+class Sprite;
+
+//! \brief Collects the contacts between AdvancedCollisionSprites during a tick and dispatches them once per tick.
+//!
+//! The same contact is usually detected on every tick (an entity resting on a platform,
+//! a particle overlapping the player...). Instead of notifying every detection,
+//! contacts are recorded in a set during the tick, which removes the duplicates.
+//!
+//! After the tick, flush() compares the contacts of the tick with the contacts of the previous tick :
+//! - A contact that wasn't there on the previous tick begins (ContactBegin).
+//! - A contact that was already there on the previous tick stays (ContactStay).
+//! - A contact of the previous tick that wasn't recorded again ends (ContactEnd).
+//!
+//! Each event is dispatched to the receiver of the contact with AdvancedCollisionSprite::onContact.
+//!
+//! A contact therefore lasts as long as it is recorded on every tick.
+//! Contacts involving a sprite that leaves the scene are dropped with remove(), without an end event.
+class ContactEventQueue {
+
+public:
+    //! The kind of intersection that caused the contact.
+    enum ContactType {
+        TriggerContact,     // The receiver is a trigger intersected by the other sprite
+        CollisionContact,   // The receiver collided with the other sprite
+        SteppedOnContact    // The receiver was stepped on by the other sprite (a physics entity)
+    };
+
+    //! The transition of a contact between two ticks.
+    enum ContactPhase {
+        ContactBegin,
+        ContactStay,
+        ContactEnd
+    };
+
+    void record(AdvancedCollisionSprite* pReceiver, AdvancedCollisionSprite* pOther, ContactType type);
+    void remove(const Sprite* pSprite);
+    void flush();
+    void clear();
+
+    [[nodiscard]] inline int contactCount() const { return static_cast<int>(m_previousContacts.count()); }
+
+private:
+    //! A contact between two sprites, as seen by its receiver.
+    struct Contact {
+        AdvancedCollisionSprite* pReceiver;
+        AdvancedCollisionSprite* pOther;
+        ContactType type;
+
+        inline bool operator==(const Contact& rOther) const {
+            return pReceiver == rOther.pReceiver && pOther == rOther.pOther && type == rOther.type;
+        }
+        [[nodiscard]] bool involves(const Sprite* pSprite) const;
+
+        friend inline size_t qHash(const Contact& rContact, size_t seed = 0) noexcept {
+            return qHashMulti(seed, rContact.pReceiver, rContact.pOther, static_cast<int>(rContact.type));
+        }
+    };
+
+    //! A contact transition waiting to be dispatched.
+    struct Event {
+        Contact contact;
+        ContactPhase phase;
+    };
+
+    QSet<Contact> m_currentContacts;   // Contacts recorded during the current tick
+    QSet<Contact> m_previousContacts;  // Contacts recorded during the previous tick
+    QList<Event> m_pendingEvents;      // Events being dispatched by flush()
+};
+
+
+#endif //INC_2023_JCO_AIRTIME_CONTACTEVENTQUEUE_H
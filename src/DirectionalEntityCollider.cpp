@@ -4,9 +4,12 @@
 
 #include "DirectionalEntityCollider.h"
 
-DirectionalEntityCollider::DirectionalEntityCollider(QGraphicsItem* pParent) : AdvancedCollisionSprite(pParent) {}
+DirectionalEntityCollider::DirectionalEntityCollider(QGraphicsItem* pParent) : AdvancedCollisionSprite(pParent) {
+    addCapability(DirectionalColliderCapability);
+}
 DirectionalEntityCollider::DirectionalEntityCollider(const QString& rImagePath, QGraphicsItem* pParent) : AdvancedCollisionSprite(rImagePath, pParent) {
-    collisionTag = "BlockAll";
+    addCapability(DirectionalColliderCapability);
+    setCollisionTag("BlockAll");
 }
 DirectionalEntityCollider::DirectionalEntityCollider(const QString& rImagePath, BlockingSides blockingSides, QGraphicsItem* pParent) : DirectionalEntityCollider(rImagePath, pParent) {
     m_blockingSides = blockingSides;
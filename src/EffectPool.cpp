@@ -0,0 +1,139 @@
+//
+// Created by blatnoa on 13.06.2023.
+//
+
+#include "EffectPool.h"
+
+#include "AnimatedSprite.h"
+#include "gamescene.h"
+#include "ParticleEmitter.h"
+
+//! Constructor :
+//! Creates an empty pool. The effects are created the first time they are needed.
+//! \param pScene The scene in which the effects are shown.
+EffectPool::EffectPool(GameScene* pScene) {
+    m_pScene = pScene;
+}
+
+//! Returns the particle emitter of the given image.
+//! The emitter is created and added to the scene the first time, then shared by all its users.
+//! The users set the modifiers of the emitter before spawning their particles.
+//! \param rImagePath The path to the image of the particles.
+//! \return The particle emitter.
+ParticleEmitter* EffectPool::particleEmitter(const QString& rImagePath) {
+    auto it = m_particleEmitters.find(rImagePath);
+    if (it != m_particleEmitters.end()) {
+        return it.value();
+    }
+
+    auto* pEmitter = new ParticleEmitter(rImagePath);
+    m_particleEmitters.insert(rImagePath, pEmitter);
+    m_pScene->addSpriteToScene(pEmitter);
+
+    QObject::connect(pEmitter, &QObject::destroyed, [this, rImagePath]() {
+        m_particleEmitters.remove(rImagePath);
+    });
+
+    return pEmitter;
+}
+
+//! Plays a one-shot animation.
+//! An idle effect with the same sprite sheet is reused if there is one. Otherwise, a new one is created.
+//! The effect is hidden and returned to the pool once its animation is over.
+//! \param rSpriteSheet The sprite sheet of the animation.
+//! \param frameDurations The durations of each frame of the animation.
+//! \return The effect, to be placed by the caller.
+AnimatedSprite* EffectPool::playEffect(const QPixmap& rSpriteSheet, const QList<int>& frameDurations) {
+    const qint64 spriteSheetKey = rSpriteSheet.cacheKey();
+
+    AnimatedSprite* pEffect = nullptr;
+    auto it = m_idleEffects.find(spriteSheetKey);
+    if (it != m_idleEffects.end() && !it.value().isEmpty()) {
+        pEffect = it.value().takeLast();
+        pEffect->setVisible(true);
+        pEffect->startAnimation();
+    } else {
+        // Looping, so that the animation doesn't destroy the effect : it is stopped at the end of its cycle instead
+        pEffect = new AnimatedSprite(rSpriteSheet.toImage(), frameDurations, true);
+        pEffect->setEmitSignalEndOfAnimationEnabled(true);
+        m_pScene->addSpriteToScene(pEffect);
+        m_effectSpriteSheets.insert(pEffect, spriteSheetKey);
+
+        QObject::connect(pEffect, &AnimatedSprite::animationFinished, [this, pEffect, spriteSheetKey]() {
+            recycleEffect(pEffect, spriteSheetKey);
+        });
+        QObject::connect(pEffect, &QObject::destroyed, [this, pEffect, spriteSheetKey]() {
+            forgetEffect(pEffect, spriteSheetKey);
+        });
+    }
+
+    pEffect->stopAnimation(Sprite::END_OF_CYCLE_STOP);
+    return pEffect;
+}
+
+//! Returns the number of effects waiting in the pool to be played again.
+//! \return The number of idle effects.
+int EffectPool::idleEffectCount() const {
+    int count = 0;
+    for (const QList<AnimatedSprite*>& rEffects : m_idleEffects) {
+        count += static_cast<int>(rEffects.size());
+    }
+    return count;
+}
+
+//! Indicates if the given sprite is one of the effects of the pool.
+//! The effects of the pool belong to the scene rather than to a level : they must not be deleted
+//! when a level is unloaded, otherwise the pool would hand them out again until they are destroyed.
+//! \param pSprite The sprite to check.
+//! \return true if the sprite is a particle emitter or an effect of the pool.
+bool EffectPool::contains(const Sprite* pSprite) const {
+    // The pool only holds a few effects : a linear search is enough
+    for (const ParticleEmitter* pEmitter : m_particleEmitters) {
+        if (pEmitter == pSprite) {
+            return true;
+        }
+    }
+    for (auto it = m_effectSpriteSheets.cbegin(); it != m_effectSpriteSheets.cend(); ++it) {
+        if (it.key() == pSprite) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//! Resets the effects of the pool, when a level is unloaded.
+//! The particles of the emitters are removed and the effects still playing are stopped and returned to the pool.
+//! The effects themselves stay in the scene, ready to be reused by the next level.
+void EffectPool::reset() {
+    for (ParticleEmitter* pEmitter : m_particleEmitters) {
+        pEmitter->clearParticles();
+        pEmitter->setTravelTarget(nullptr);
+    }
+
+    for (auto it = m_effectSpriteSheets.cbegin(); it != m_effectSpriteSheets.cend(); ++it) {
+        AnimatedSprite* pEffect = it.key();
+        if (pEffect->isVisible()) {
+            pEffect->stopAnimation(Sprite::IMMEDIATE_STOP);
+            recycleEffect(pEffect, it.value());
+        }
+    }
+}
+
+//! Hides an effect whose animation is over and returns it to the pool.
+//! \param pEffect The effect.
+//! \param spriteSheetKey The key of the sprite sheet of the effect.
+void EffectPool::recycleEffect(AnimatedSprite* pEffect, qint64 spriteSheetKey) {
+    pEffect->setVisible(false);
+    m_idleEffects[spriteSheetKey].append(pEffect);
+}
+
+//! Removes a destroyed effect from the pool.
+//! \param pEffect The effect.
+//! \param spriteSheetKey The key of the sprite sheet of the effect.
+void EffectPool::forgetEffect(AnimatedSprite* pEffect, qint64 spriteSheetKey) {
+    m_effectSpriteSheets.remove(pEffect);
+    auto it = m_idleEffects.find(spriteSheetKey);
+    if (it != m_idleEffects.end()) {
+        it.value().removeOne(pEffect);
+    }
+}
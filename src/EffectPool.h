@@ -0,0 +1,60 @@
+/**
+\file     EffectPool.h
+\brief    Déclaration de la classe EffectPool.
+\author   Blattner Noah
+\date     juin 2023
+*/
+
+#ifndef INC_2023_JCO_AIRTIME_EFFECTPOOL_H
+#define INC_2023_JCO_AIRTIME_EFFECTPOOL_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+class AnimatedSprite;
+class GameScene;
+class ParticleEmitter;
+class QPixmap;
+class Sprite;
+
+//! \brief The visual effects of a scene, created once and then reused.
+//!
+//! Effects such as particle bursts or the dust of the player are spawned very often and only live
+//! for a short time. Creating a sprite for each of them would allocate a QObject, a graphics item
+//! and its images every time, then destroy them a few milliseconds later.
+//!
+//! Instead, the pool keeps the effects of its scene :
+//!     - particleEmitter() returns the ParticleEmitter of an image, shared by every burst of particles
+//!       drawn with that image. Its particles live in arrays that keep their capacity once they are empty.
+//!     - playEffect() plays a one-shot animation. When the animation ends, its sprite is hidden and kept
+//!       in the pool, then reused by the next effect with the same sprite sheet.
+//! Once every effect has been played once, playing effects doesn't allocate anymore.
+//!
+//! The effects stay in the scene, which destroys them along with the other sprites. They outlive the levels :
+//! a level is unloaded without the effects of the pool (see contains()), which are only reset() instead.
+class EffectPool {
+
+public:
+    explicit EffectPool(GameScene* pScene);
+
+    ParticleEmitter* particleEmitter(const QString& rImagePath);
+    AnimatedSprite* playEffect(const QPixmap& rSpriteSheet, const QList<int>& frameDurations);
+
+    [[nodiscard]] int idleEffectCount() const;
+    [[nodiscard]] bool contains(const Sprite* pSprite) const;
+
+    void reset();
+
+private:
+    void recycleEffect(AnimatedSprite* pEffect, qint64 spriteSheetKey);
+    void forgetEffect(AnimatedSprite* pEffect, qint64 spriteSheetKey);
+
+    GameScene* m_pScene;
+    QHash<QString, ParticleEmitter*> m_particleEmitters;     // Emitter of each particle image
+    QHash<qint64, QList<AnimatedSprite*>> m_idleEffects;     // Hidden effects of each sprite sheet (QPixmap::cacheKey())
+    QHash<AnimatedSprite*, qint64> m_effectSpriteSheets;     // Sprite sheet key of every effect, idle or playing
+};
+
+
+#endif //INC_2023_JCO_AIRTIME_EFFECTPOOL_H
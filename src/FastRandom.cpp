@@ -0,0 +1,43 @@
+//
+// Created by blatnoa on 14.06.2023.
+//
+
+#include "FastRandom.h"
+
+//! Returns the next number of a splitmix64 sequence, used to spread a seed over the whole state.
+//! \param rState The state of the sequence.
+//! \return The next number.
+static quint64 splitMix64(quint64& rState) {
+    quint64 z = (rState += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+//! Constructor :
+//! Seeds the generator.
+//! \param seed The seed. The same seed always gives the same sequence.
+//! \param stream The stream of the seed. Generators with the same seed but different streams
+//! give independent sequences, for example one per chunk of a parallel loop.
+FastRandom::FastRandom(quint64 seed, quint64 stream) {
+    this->seed(seed, stream);
+}
+
+//! Restarts the sequence from the given seed.
+//! \param seed The seed.
+//! \param stream The stream of the seed (see the constructor).
+void FastRandom::seed(quint64 seed, quint64 stream) {
+    quint64 splitMixState = seed ^ splitMix64(stream);
+
+    quint64 first = splitMix64(splitMixState);
+    quint64 second = splitMix64(splitMixState);
+    m_state[0] = static_cast<quint32>(first);
+    m_state[1] = static_cast<quint32>(first >> 32);
+    m_state[2] = static_cast<quint32>(second);
+    m_state[3] = static_cast<quint32>(second >> 32);
+
+    // xoshiro can't leave an all-zero state
+    if ((m_state[0] | m_state[1] | m_state[2] | m_state[3]) == 0) {
+        m_state[0] = 1;
+    }
+}
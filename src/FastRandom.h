@@ -0,0 +1,66 @@
+/**
+\file     FastRandom.h
+\brief    Déclaration de la classe FastRandom.
+\author   Blattner Noah
+\date     juin 2023
+*/
+
+#ifndef INC_2023_JCO_AIRTIME_FASTRANDOM_H
+#define INC_2023_JCO_AIRTIME_FASTRANDOM_H
+
+#include <QtGlobal>
+
+//! \brief A small and fast pseudo-random generator (xoshiro128**), for visual effects.
+//!
+//! QRandomGenerator::global() is shared by the whole program and protected by a lock, so each call is expensive.
+//! A FastRandom is instead owned by the object that uses it (a particle emitter...) : drawing a number only
+//! takes a few shifts and multiplications. It is not thread-safe, but a parallel loop can give each chunk of
+//! its work its own generator on an independent stream (see the constructor).
+//!
+//! The same seed always gives the same sequence of numbers, on every platform,
+//! so that effects can be replayed bit for bit, for example in a benchmark.
+//! The generator is not suited for anything that needs unpredictable numbers.
+class FastRandom {
+
+public:
+    explicit FastRandom(quint64 seed = DEFAULT_SEED, quint64 stream = 0);
+
+    void seed(quint64 seed, quint64 stream = 0);
+
+    //! Returns the next random 32 bits number.
+    inline quint32 generate() {
+        const quint32 result = rotateLeft(m_state[1] * 5, 7) * 9;
+        const quint32 t = m_state[1] << 9;
+
+        m_state[2] ^= m_state[0];
+        m_state[3] ^= m_state[1];
+        m_state[1] ^= m_state[2];
+        m_state[0] ^= m_state[3];
+        m_state[2] ^= t;
+        m_state[3] = rotateLeft(m_state[3], 11);
+
+        return result;
+    }
+
+    //! Returns a random number between 0 (included) and 1 (excluded).
+    inline float generateFloat() {
+        return static_cast<float>(generate() >> 8) * (1.0f / 16777216.0f); // 24 bits, the precision of a float
+    }
+
+    //! Returns a random number between 0 (included) and the given bound (excluded).
+    inline float bounded(float highest) {
+        return generateFloat() * highest;
+    }
+
+private:
+    static constexpr quint64 DEFAULT_SEED = 0x2023A1C0FFEEULL;
+
+    static inline quint32 rotateLeft(quint32 value, int shift) {
+        return (value << shift) | (value >> (32 - shift));
+    }
+
+    quint32 m_state[4];
+};
+
+
+#endif //INC_2023_JCO_AIRTIME_FASTRANDOM_H
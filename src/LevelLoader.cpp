@@ -76,7 +76,12 @@ QList<Sprite *> LevelLoader::loadLevel(const QString& levelName) {
     m_pCore->scene()->setBackgroundImage(backgroundImage);
 
     // Load the sprites
-    return loadSprites(levelObject["sprites"].toArray());
+    QList<Sprite*> sprites = loadSprites(levelObject["sprites"].toArray());
+
+    // Bake the static geometry of the level once, instead of on the first collision query
+    m_pCore->scene()->bakeStaticSprites();
+
+    return sprites;
 }
 
 //! Loads sprites into the scene.
@@ -121,6 +126,9 @@ Sprite* LevelLoader::loadSprite(const QJsonObject &spriteObject) {
         applyParameters(sprite, tagInfos[1]);
     }
 
+    // Only physics entities move, everything else is static level geometry
+    sprite->setStatic(!sprite->hasCapability(Sprite::PhysicsCapability));
+
     m_pCore->scene()->addSpriteToScene(sprite); // Add the sprite to the scene
 
     return sprite;
@@ -182,7 +190,7 @@ Sprite* LevelLoader::generateSprite(const QString &tag, const QString &imagePath
         auto* advSprite = new AdvancedCollisionSprite(imagePath);
 
         // Set the tag of the sprite as the collision tag
-        advSprite->collisionTag = tag;
+        advSprite->setCollisionTag(tag);
 
         sprite = advSprite;
     }
@@ -193,11 +201,16 @@ Sprite* LevelLoader::generateSprite(const QString &tag, const QString &imagePath
 void LevelLoader::unloadLevel() {
     m_currentLevel = "";
 
-    // Delete all sprites
+    // Delete all sprites, except the effects of the pool, which are reused by the next level
+    EffectPool& rEffectPool = m_pCore->scene()->effectPool();
     for (Sprite* sprite : m_pCore->scene()->sprites()) {
+        if (rEffectPool.contains(sprite))
+            continue;
+
         m_pCore->scene()->removeSpriteFromScene(sprite);
         sprite->deleteLater();
     }
+    rEffectPool.reset();
 }
 
 //! Reloads the current level.
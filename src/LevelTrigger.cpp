@@ -5,6 +5,7 @@
 #include "LevelTrigger.h"
 
 #include "GameCore.h"
+#include "Player.h"
 #include <QDir>
 LevelTrigger::LevelTrigger(GameCore* gameCore, QString levelName, QGraphicsItem* pParent) : AdvancedCollisionSprite(pParent) {
     m_pCore = gameCore;
@@ -17,14 +18,19 @@ LevelTrigger::LevelTrigger(GameCore* gameCore, QString levelName, QGraphicsItem*
     isTrigger = true;
 }
 
-//! Override of the onTrigger method :
-//! Loads the level when the player collides with the trigger.
-//! \param pOther The other sprite.
-void LevelTrigger::onTrigger(AdvancedCollisionSprite* pOther) {
-    AdvancedCollisionSprite::onTrigger(pOther);
+//! Override of the onContact method :
+//! Loads the level when the player starts colliding with the trigger.
+//! The level is loaded once the physics of the tick is over, when the contacts are dispatched.
+//! \param pOther The other sprite of the contact.
+//! \param type The kind of intersection that caused the contact.
+//! \param phase Whether the contact begins, stays or ends.
+void LevelTrigger::onContact(AdvancedCollisionSprite* pOther, ContactEventQueue::ContactType type,
+                             ContactEventQueue::ContactPhase phase) {
+    AdvancedCollisionSprite::onContact(pOther, type, phase);
 
-    // If the other sprite is the player
-    if (pOther->collisionTag == "Player") {
+    // If the player enters the trigger
+    if (phase == ContactEventQueue::ContactBegin && type == ContactEventQueue::TriggerContact
+        && pOther->collisionLayer() == Player::PLAYER_LAYER) {
         // Load the level specified in the constructor
         m_pCore->loadLevel(m_levelName);
     }
@@ -27,7 +27,8 @@ public:
     LevelTrigger(GameCore* gameCore, QString levelName, QGraphicsItem* pParent = nullptr);
 
 protected:
-    void onTrigger(AdvancedCollisionSprite* pOther) override;
+    void onContact(AdvancedCollisionSprite* pOther, ContactEventQueue::ContactType type,
+                   ContactEventQueue::ContactPhase phase) override;
 
 private:
     GameCore* m_pCore;
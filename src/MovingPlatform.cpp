@@ -45,17 +45,28 @@ void MovingPlatform::endMove() {
         direction = BACK;
 
         // Wait 1 second before moving back
-        QTimer::singleShot(1000, this, SLOT(startMove()));
+        scheduleAfter(1000, [this]() { startMove(); });
     } else {
         direction = FORTH;
     }
 }
 
-//! Override of the onSteppedOn function.
-//! Triggered when an entity steps on the platform.
-//! Starts the movement of the platform.
-//! \param pEntity The entity that stepped on the platform.
-void MovingPlatform::onSteppedOn(PhysicsEntity* pEntity) {
+//! Override of the onContact function.
+//! Triggered once per contact transition, after the physics of the tick.
+//! When an entity steps on the platform, starts the movement of the platform.
+//! \param pOther The other sprite of the contact.
+//! \param type The kind of intersection that caused the contact.
+//! \param phase Whether the contact begins, stays or ends.
+void MovingPlatform::onContact(AdvancedCollisionSprite* pOther, ContactEventQueue::ContactType type,
+                               ContactEventQueue::ContactPhase phase) {
+    PhysicsEntity::onContact(pOther, type, phase);
+
+    if (phase != ContactEventQueue::ContactBegin || type != ContactEventQueue::SteppedOnContact) {
+        return;
+    }
+
+    // Stepped on contacts are only recorded by physics entities
+    auto* pEntity = static_cast<PhysicsEntity*>(pOther);
     pEntity->setParent(this);
 
     if (direction == BACK || moving) { // If the platform is already moving or will move back,
@@ -69,4 +80,13 @@ void MovingPlatform::onSteppedOn(PhysicsEntity* pEntity) {
 void MovingPlatform::startMove() {
     moving = true;
     moveTime = 0;
+
+    wakeUp();
+}
+
+//! Override of the isAtRest function.
+//! The platform is at rest as long as it isn't moving, wherever it is.
+//! \return True if the platform isn't moving.
+bool MovingPlatform::isAtRest() const {
+    return !moving;
 }
@@ -12,17 +12,24 @@
 //!
 //! This class is used to create moving platforms.
 //!
-//! It is activated when a player steps on it.
+//! It is activated when an entity steps on it (the beginning of a SteppedOnContact).
+//! An entity that stays on the platform after its return has to step on it again to activate it.
 //! When activated, it will move in a direction over a certain amount of time.
 //! When it reaches the end of its path, it will move back to its original position.
+//!
+//! The platform moves in the pre-physics phase of the tick, so that the entities it carries
+//! move from its new position during the physics phase.
+//! While it isn't moving, the platform sleeps and is woken up when it starts moving.
 class MovingPlatform : public PhysicsEntity {
 
 public:
     MovingPlatform(QVector2D moveVector, float moveDuration, QGraphicsItem* pParent = nullptr);
 
-    void onSteppedOn(PhysicsEntity* pEntity) override;
+    void onContact(AdvancedCollisionSprite* pOther, ContactEventQueue::ContactType type,
+                   ContactEventQueue::ContactPhase phase) override;
 
     void tick(long long int elapsedTimeInMilliseconds) override;
+    [[nodiscard]] TickPhase tickPhase() const override { return PrePhysicsPhase; }
 
     enum Direction {
         FORTH,
@@ -39,6 +46,9 @@ private:
     void startMove();
 
     void endMove();
+
+protected:
+    [[nodiscard]] bool isAtRest() const override;
 };
 
 
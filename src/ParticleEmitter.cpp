@@ -0,0 +1,463 @@
+//
+// Created by blatnoa on 11.06.2023.
+//
+
+#include "ParticleEmitter.h"
+
+#include "gamescene.h"
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <QPainter>
+#include <QRandomGenerator>
+
+//! Constructor :
+//! Loads the image drawn for each particle. The emitter starts without particles.
+//! \param rImagePath The path to the image of the particles.
+//! \param pParent The parent of the emitter.
+ParticleEmitter::ParticleEmitter(const QString& rImagePath, QGraphicsItem* pParent)
+: Sprite(pParent), m_particlePixmap(rImagePath), m_random(QRandomGenerator::global()->generate64()) {
+    addCapability(SelfInterpolatedCapability);
+}
+
+//! Override of the setParentScene function.
+//! Registers the emitter for ticks if it already has particles.
+//! \param pScene The parent scene.
+void ParticleEmitter::setParentScene(GameScene* pScene) {
+    Sprite::setParentScene(pScene);
+
+    if (pScene != nullptr && particleCount() > 0) {
+        registerForTick(PostPhysicsPhase);
+    }
+}
+
+//! Spawns particles of the given type with a random velocity.
+//! \param type The type of the particles.
+//! \param scenePosition The position at which the particles are spawned, in scene coordinates.
+//! \param count The number of particles to spawn.
+void ParticleEmitter::spawnParticles(ParticleType type, QPointF scenePosition, int count) {
+    if (count <= 0) {
+        return;
+    }
+
+    QPointF position = mapFromScene(scenePosition);
+    float speedRange = initialSpeed * randomisation;
+    float lifetime = fadeTime * 1000.0f;
+
+    int newCount = particleCount() + count;
+    m_positionsX.reserve(newCount);
+    m_positionsY.reserve(newCount);
+    m_velocitiesX.reserve(newCount);
+    m_velocitiesY.reserve(newCount);
+    m_ages.reserve(newCount);
+    m_lifetimes.reserve(newCount);
+    m_opacities.reserve(newCount);
+    m_gravities.reserve(newCount);
+    m_accelerations.reserve(newCount);
+    m_fadeRates.reserve(newCount);
+    m_rotations.reserve(newCount);
+    m_randomisations.reserve(newCount);
+    m_travelSpeeds.reserve(newCount);
+    m_travelLerpRates.reserve(newCount);
+    m_types.reserve(newCount);
+
+    // Gravity, acceleration, fade and travel of each type
+    float gravity = 0;
+    float particleAcceleration = 0;
+    float fadeRate = 0;
+    float travelSpeed = 0;
+    float travelLerpRate = 0;
+    switch (type) {
+        case DEFAULT:
+            gravity = DEFAULT_GRAVITY;
+            break;
+        case EXPLOSIVE:
+            particleAcceleration = acceleration;
+            fadeRate = 1.0f / lifetime;
+            break;
+        case SMOKE:
+            gravity = SMOKE_GRAVITY;
+            particleAcceleration = acceleration;
+            fadeRate = 1.0f / lifetime;
+            break;
+        case DUST:
+            gravity = DUST_GRAVITY;
+            particleAcceleration = acceleration;
+            fadeRate = 1.0f / lifetime;
+            break;
+        case TRAVEL:
+            travelSpeed = initialSpeed;
+            travelLerpRate = std::clamp(acceleration, 0.0f, 1.0f);
+            break;
+    }
+
+    for (int i = 0; i < count; i++) {
+        float velocityX = randomOffset(speedRange, m_random);
+        float velocityY = randomOffset(speedRange, m_random);
+
+        // SMOKE rises and DUST falls, at the initial speed
+        if (type == SMOKE) {
+            velocityY = -initialSpeed;
+        } else if (type == DUST) {
+            velocityY = initialSpeed;
+        }
+
+        m_positionsX << static_cast<float>(position.x());
+        m_positionsY << static_cast<float>(position.y());
+        m_velocitiesX << velocityX;
+        m_velocitiesY << velocityY;
+        m_ages << 0.0f;
+        m_lifetimes << lifetime;
+        m_opacities << 1.0f;
+        m_gravities << gravity;
+        m_accelerations << particleAcceleration;
+        m_fadeRates << fadeRate;
+        m_rotations << (spinSpeed != 0 ? m_random.bounded(360.0f) : 0.0f);
+        m_randomisations << randomisation;
+        m_travelSpeeds << travelSpeed;
+        m_travelLerpRates << travelLerpRate;
+        m_types << static_cast<quint8>(type);
+    }
+
+    updateParticlesRect();
+
+    if (m_pParentScene != nullptr) {
+        registerForTick(PostPhysicsPhase);
+    }
+}
+
+//! Removes all the particles of the emitter.
+void ParticleEmitter::clearParticles() {
+    m_positionsX.clear();
+    m_positionsY.clear();
+    m_velocitiesX.clear();
+    m_velocitiesY.clear();
+    m_ages.clear();
+    m_lifetimes.clear();
+    m_opacities.clear();
+    m_gravities.clear();
+    m_accelerations.clear();
+    m_fadeRates.clear();
+    m_rotations.clear();
+    m_randomisations.clear();
+    m_travelSpeeds.clear();
+    m_travelLerpRates.clear();
+    m_types.clear();
+
+    updateParticlesRect();
+}
+
+//! Set the target chased by the TRAVEL particles.
+//! If the target is destroyed, the TRAVEL particles disappear.
+//! \param pTarget The target of the particles.
+void ParticleEmitter::setTravelTarget(Sprite* pTarget) {
+    m_pTravelTarget = pTarget;
+}
+
+//! Restarts the random numbers of the emitter from the given seed.
+//! The particles spawned afterwards, and their steering, are then the same on every run.
+//! \param seed The seed.
+void ParticleEmitter::setRandomSeed(quint64 seed) {
+    m_random.seed(seed);
+}
+
+//! Override of the localBoundingRect function.
+//! \return The rect covering all the particles, in the coordinates of the emitter.
+QRectF ParticleEmitter::localBoundingRect() const {
+    return m_particlesRect;
+}
+
+//! Override of the paint function.
+//! Draws all the particles in a single call, each centered on its position, with its opacity and rotation.
+//! The particles are drawn between their position at the start and at the end of the last tick,
+//! according to the render progress of the scene.
+void ParticleEmitter::paint(QPainter* pPainter, const QStyleOptionGraphicsItem* pOption, QWidget* pWidget) {
+    Q_UNUSED(pOption);
+    Q_UNUSED(pWidget);
+
+    if (m_particlePixmap.isNull() || particleCount() == 0) {
+        return;
+    }
+
+    const QRectF sourceRect = m_particlePixmap.rect();
+    const float remainingProgress = m_pParentScene != nullptr ? 1.0f - static_cast<float>(m_pParentScene->renderProgress()) : 0.0f;
+
+    m_fragments.resize(particleCount());
+    for (int i = 0; i < particleCount(); i++) {
+        float stepBack = previousStepDuration(i) * remainingProgress;
+        QPointF position(m_positionsX.at(i) - m_velocitiesX.at(i) * stepBack, m_positionsY.at(i) - m_velocitiesY.at(i) * stepBack);
+        m_fragments[i] = QPainter::PixmapFragment::create(position, sourceRect,
+                                                          particleScale, particleScale, m_rotations.at(i), m_opacities.at(i));
+    }
+
+    pPainter->drawPixmapFragments(m_fragments.constData(), static_cast<int>(m_fragments.size()), m_particlePixmap);
+}
+
+//! Tick handler :
+//! Updates all the particles chunk by chunk, then removes the dead ones.
+//! From PARALLEL_PARTICLE_COUNT particles, the chunks are updated in parallel by the WorkStealingPool.
+//! Each chunk draws its random numbers from its own stream of a seed drawn once per tick,
+//! so the particles are the same whether the chunks are updated in parallel or not.
+//! Once the emitter has no particles left, it unregisters from the tick.
+//! \param elapsedTimeInMilliseconds The elapsed time in milliseconds.
+void ParticleEmitter::tick(long long elapsedTimeInMilliseconds) {
+    const int count = particleCount();
+    const int chunkCount = (count + PARTICLE_CHUNK_SIZE - 1) / PARTICLE_CHUNK_SIZE;
+
+    // Everything the chunks need from the emitter and the scene is read here, on the thread of the scene
+    ChunkTickContext context;
+    context.elapsedTime = static_cast<float>(elapsedTimeInMilliseconds);
+    context.seed = static_cast<quint64>(m_random.generate()) << 32;
+    context.seed |= m_random.generate();
+    context.instructionSet = ParticleKernels::instructionSet();
+    context.hasTravelTarget = !m_pTravelTarget.isNull();
+    if (context.hasTravelTarget) {
+        context.travelTargetPosition = mapFromScene(m_pTravelTarget->globalBoundingRect().center());
+    }
+
+    if (count >= PARALLEL_PARTICLE_COUNT) {
+        WorkStealingPool::instance().parallelFor(chunkCount, [&](int chunkIndex) {
+            tickChunk(chunkIndex, context);
+        }, 1);
+    } else {
+        for (int chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++) {
+            tickChunk(chunkIndex, context);
+        }
+    }
+
+    m_lastTickDuration = context.elapsedTime;
+    removeDeadParticles();
+
+    updateParticlesRect();
+    update();
+
+    if (particleCount() == 0 && m_pParentScene != nullptr) {
+        unregisterFromTick();
+    }
+}
+
+//! Updates the particles of a chunk : steering, spin, then the ParticleKernels.
+//! Only changes the particles of the chunk, so the chunks can be updated on several threads.
+//! The lists are never shared with another list, so data() doesn't detach them.
+//! \param chunkIndex The index of the chunk, made of PARTICLE_CHUNK_SIZE particles.
+//! \param rContext The data of the tick, shared by all the chunks.
+void ParticleEmitter::tickChunk(int chunkIndex, const ChunkTickContext& rContext) {
+    const int begin = chunkIndex * PARTICLE_CHUNK_SIZE;
+    const int end = std::min(begin + PARTICLE_CHUNK_SIZE, particleCount());
+    const int count = end - begin;
+    FastRandom random(rContext.seed, static_cast<quint64>(chunkIndex));
+
+    steerParticles(begin, end, rContext, random);
+    spinParticles(begin, end, rContext.elapsedTime);
+    ParticleKernels::accelerate(m_velocitiesX.data() + begin, m_velocitiesY.data() + begin,
+                                m_gravities.constData() + begin, m_accelerations.constData() + begin,
+                                count, friction, rContext.elapsedTime, rContext.instructionSet);
+    ParticleKernels::integratePositions(m_positionsX.data() + begin, m_positionsY.data() + begin,
+                                        m_velocitiesX.constData() + begin, m_velocitiesY.constData() + begin,
+                                        count, rContext.elapsedTime, rContext.instructionSet);
+    ParticleKernels::fade(m_ages.data() + begin, m_opacities.data() + begin, m_fadeRates.constData() + begin,
+                          count, rContext.elapsedTime, rContext.instructionSet);
+}
+
+//! Applies the random steering of the type of each particle to its velocity.
+//! The particles that fade wander randomly, the TRAVEL particles steer towards the travel target.
+//! \param begin The index of the first particle (included).
+//! \param end The index of the last particle (excluded).
+//! \param rContext The data of the tick.
+//! \param rRandom The random generator of the chunk.
+void ParticleEmitter::steerParticles(int begin, int end, const ChunkTickContext& rContext, FastRandom& rRandom) {
+    const float elapsedTimeInSeconds = rContext.elapsedTime / 1000.0f;
+    const auto targetX = static_cast<float>(rContext.travelTargetPosition.x());
+    const auto targetY = static_cast<float>(rContext.travelTargetPosition.y());
+
+    const quint8* pTypes = m_types.constData();
+    const float* pPositionsX = m_positionsX.constData();
+    const float* pPositionsY = m_positionsY.constData();
+    float* pVelocitiesX = m_velocitiesX.data();
+    float* pVelocitiesY = m_velocitiesY.data();
+    const float* pRandomisations = m_randomisations.constData();
+    const float* pTravelSpeeds = m_travelSpeeds.constData();
+    const float* pTravelLerpRates = m_travelLerpRates.constData();
+
+    for (int i = begin; i < end; i++) {
+        switch (pTypes[i]) {
+            case EXPLOSIVE:
+            case SMOKE:
+            case DUST:
+                randomizeDirection(pVelocitiesX[i], pVelocitiesY[i], pRandomisations[i], rRandom);
+                break;
+
+            case TRAVEL: {
+                if (!rContext.hasTravelTarget) { // The particle is removed by removeDeadParticles
+                    break;
+                }
+
+                float directionX = targetX - pPositionsX[i];
+                float directionY = targetY - pPositionsY[i];
+                randomizeDirection(directionX, directionY, pRandomisations[i], rRandom);
+
+                // Lerp new and old velocity
+                const float travelLerpFactor = pTravelLerpRates[i] * elapsedTimeInSeconds;
+                float length = std::sqrt(directionX * directionX + directionY * directionY);
+                float pullX = length > 0 ? directionX / length * pTravelSpeeds[i] : 0;
+                float pullY = length > 0 ? directionY / length * pTravelSpeeds[i] : 0;
+                pVelocitiesX[i] = pVelocitiesX[i] * (1.0f - travelLerpFactor) + pullX * travelLerpFactor;
+                pVelocitiesY[i] = pVelocitiesY[i] * (1.0f - travelLerpFactor) + pullY * travelLerpFactor;
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+}
+
+//! Turns each particle by spinSpeed.
+//! \param begin The index of the first particle (included).
+//! \param end The index of the last particle (excluded).
+//! \param elapsedTimeInMilliseconds The elapsed time in milliseconds.
+void ParticleEmitter::spinParticles(int begin, int end, float elapsedTimeInMilliseconds) {
+    if (spinSpeed == 0) {
+        return;
+    }
+
+    const float rotationStep = spinSpeed * elapsedTimeInMilliseconds / 1000.0f;
+    float* pRotations = m_rotations.data();
+    for (int i = begin; i < end; i++) {
+        pRotations[i] = std::fmod(pRotations[i] + rotationStep, 360.0f);
+    }
+}
+
+//! Removes the particles whose lifetime is over.
+//! TRAVEL particles are removed once they reach the travel target after their lifetime, or if the target is gone.
+void ParticleEmitter::removeDeadParticles() {
+    QRectF targetRect;
+    if (!m_pTravelTarget.isNull()) {
+        targetRect = mapRectFromScene(m_pTravelTarget->globalBoundingRect());
+    }
+
+    for (int i = particleCount() - 1; i >= 0; i--) {
+        bool isDead;
+        if (m_types.at(i) == TRAVEL) {
+            isDead = m_pTravelTarget.isNull()
+                     || (m_ages.at(i) >= m_lifetimes.at(i) && targetRect.contains(m_positionsX.at(i), m_positionsY.at(i)));
+        } else {
+            isDead = m_ages.at(i) >= m_lifetimes.at(i);
+        }
+
+        if (isDead) {
+            removeParticle(i);
+        }
+    }
+}
+
+//! Removes a particle by moving the last particle into its place.
+//! \param index The index of the particle.
+void ParticleEmitter::removeParticle(int index) {
+    const int lastIndex = particleCount() - 1;
+    if (index != lastIndex) {
+        m_positionsX[index] = m_positionsX.at(lastIndex);
+        m_positionsY[index] = m_positionsY.at(lastIndex);
+        m_velocitiesX[index] = m_velocitiesX.at(lastIndex);
+        m_velocitiesY[index] = m_velocitiesY.at(lastIndex);
+        m_ages[index] = m_ages.at(lastIndex);
+        m_lifetimes[index] = m_lifetimes.at(lastIndex);
+        m_opacities[index] = m_opacities.at(lastIndex);
+        m_gravities[index] = m_gravities.at(lastIndex);
+        m_accelerations[index] = m_accelerations.at(lastIndex);
+        m_fadeRates[index] = m_fadeRates.at(lastIndex);
+        m_rotations[index] = m_rotations.at(lastIndex);
+        m_randomisations[index] = m_randomisations.at(lastIndex);
+        m_travelSpeeds[index] = m_travelSpeeds.at(lastIndex);
+        m_travelLerpRates[index] = m_travelLerpRates.at(lastIndex);
+        m_types[index] = m_types.at(lastIndex);
+    }
+
+    m_positionsX.removeLast();
+    m_positionsY.removeLast();
+    m_velocitiesX.removeLast();
+    m_velocitiesY.removeLast();
+    m_ages.removeLast();
+    m_lifetimes.removeLast();
+    m_opacities.removeLast();
+    m_gravities.removeLast();
+    m_accelerations.removeLast();
+    m_fadeRates.removeLast();
+    m_rotations.removeLast();
+    m_randomisations.removeLast();
+    m_travelSpeeds.removeLast();
+    m_travelLerpRates.removeLast();
+    m_types.removeLast();
+}
+
+//! Updates the bounding rect of the emitter so that it covers all the particles,
+//! at their current position and at their position at the start of the last tick (see paint).
+//! Informs the scene when the rect changes, so that it updates its spatial index.
+void ParticleEmitter::updateParticlesRect() {
+    QRectF particlesRect;
+
+    if (particleCount() > 0) {
+        float minX = std::numeric_limits<float>::max();
+        float minY = std::numeric_limits<float>::max();
+        float maxX = std::numeric_limits<float>::lowest();
+        float maxY = std::numeric_limits<float>::lowest();
+        for (int i = 0; i < particleCount(); i++) {
+            float stepDuration = previousStepDuration(i);
+            float previousX = m_positionsX.at(i) - m_velocitiesX.at(i) * stepDuration;
+            float previousY = m_positionsY.at(i) - m_velocitiesY.at(i) * stepDuration;
+            minX = std::min({minX, m_positionsX.at(i), previousX});
+            minY = std::min({minY, m_positionsY.at(i), previousY});
+            maxX = std::max({maxX, m_positionsX.at(i), previousX});
+            maxY = std::max({maxY, m_positionsY.at(i), previousY});
+        }
+
+        // Grow the rect by half a particle, as the particles are drawn centered on their position.
+        // A particle that spins can cover its whole diagonal.
+        QSizeF halfSize = QSizeF(m_particlePixmap.size()) * particleScale / 2;
+        if (spinSpeed != 0) {
+            qreal radius = std::hypot(halfSize.width(), halfSize.height());
+            halfSize = QSizeF(radius, radius);
+        }
+        particlesRect = QRectF(QPointF(minX, minY), QPointF(maxX, maxY))
+                .adjusted(-halfSize.width(), -halfSize.height(), halfSize.width(), halfSize.height());
+    }
+
+    if (particlesRect != m_particlesRect) {
+        prepareGeometryChange();
+        m_particlesRect = particlesRect;
+        notifyGeometryChanged();
+    }
+}
+
+//! Returns the time the particle moved during the last tick : the duration of the tick, or less
+//! if the particle was spawned during it. A particle spawned after the tick hasn't moved yet.
+//! \param index The index of the particle.
+//! \return The time in milliseconds.
+float ParticleEmitter::previousStepDuration(int index) const {
+    return std::min(m_ages.at(index), m_lastTickDuration);
+}
+
+//! Slightly randomize a direction, keeping its length.
+//! \param rX The x component of the direction.
+//! \param rY The y component of the direction.
+//! \param particleRandomisation The randomisation of the particle.
+//! \param rRandom The random generator to draw from.
+void ParticleEmitter::randomizeDirection(float& rX, float& rY, float particleRandomisation, FastRandom& rRandom) const {
+    float length = std::sqrt(rX * rX + rY * rY);
+    if (length == 0) {
+        return;
+    }
+
+    rX = (rX / length + randomOffset(particleRandomisation, rRandom)) * length;
+    rY = (rY / length + randomOffset(particleRandomisation, rRandom)) * length;
+}
+
+//! Returns a random offset between -range / 2 and range / 2.
+//! \param range The range of the offset.
+//! \param rRandom The random generator to draw from.
+//! \return The random offset.
+float ParticleEmitter::randomOffset(float range, FastRandom& rRandom) const {
+    return rRandom.generateFloat() * range - range / 2.0f;
+}
@@ -0,0 +1,167 @@
+/**
+\file     ParticleEmitter.h
+\brief    Déclaration de la classe ParticleEmitter.
+\author   Blattner Noah
+\date     juin 2023
+*/
+
+#ifndef INC_2023_JCO_AIRTIME_PARTICLEEMITTER_H
+#define INC_2023_JCO_AIRTIME_PARTICLEEMITTER_H
+
+#include <QList>
+#include <QPainter>
+#include <QPixmap>
+#include <QPointer>
+
+#include "FastRandom.h"
+#include "ParticleKernels.h"
+#include "sprite.h"
+
+//! \brief A single sprite that simulates and draws many particles.
+//!
+//! Particles are not sprites : a sprite per particle would be a QObject and a graphics item, registered for the tick
+//! and indexed by the scene. The emitter instead stores its particles in plain arrays, one per property (structure of arrays),
+//! and updates them all in a few tight loops on each tick. Bursts of thousands of particles are therefore affordable.
+//!
+//! Each particle has a ParticleType, given when it is spawned :
+//!     - DEFAULT: Fall with the default gravity of a physics entity. They disappear at the end of their lifetime, without fading.
+//!     - EXPLOSIVE: Fly away from their spawn location in a random direction and fade out.
+//!     - SMOKE: Rise slowly and fade out.
+//!     - DUST: Fall slowly and fade out.
+//!     - TRAVEL: Chase the travel target of the emitter (see setTravelTarget). They disappear when they reach it,
+//!               once their lifetime is over, or when the target is destroyed.
+//!
+//! The randomisation, initialSpeed, acceleration and fadeTime of a particle are those of the emitter when the particle
+//! is spawned : changing them only affects the particles spawned afterwards, so that users sharing an emitter
+//! (see EffectPool) don't change the particles already in flight. friction, spinSpeed and particleScale are shared
+//! by all the particles of the emitter.
+//! Modifiers:
+//!     - randomisation: The amount of randomness applied to the particles.
+//!                      Each component of the initial velocity is a random value between -initialSpeed * randomisation / 2
+//!                      and +initialSpeed * randomisation / 2. On each tick, the direction of the particles is modified
+//!                      by a random amount between -randomisation / 2 and +randomisation / 2.
+//!     - initialSpeed: The speed at which the particles are spawned. SMOKE and DUST particles start moving vertically at this speed,
+//!                     TRAVEL particles chase their target at this speed.
+//!     - acceleration: The acceleration of the particles, along their velocity : currentVelocity += acceleration * elapsedTimeInMilliseconds / 1000.0f.
+//!                     TRAVEL particles use it to lerp their velocity towards the target instead. (Limited to 0.0f - 1.0f)
+//!     - fadeTime: The particles fade from 1.0f to 0.0f in fadeTime seconds.
+//!                 TRAVEL particles have to exist for fadeTime seconds before they can be removed by reaching their target.
+//!     - friction: The part of the velocity lost per second.
+//!     - spinSpeed: The rotation speed of the particles, in degrees per second. Spinning particles start from a random angle.
+//!     - particleScale: The scale at which the particles are drawn.
+//!
+//! The particles are updated in chunks of PARTICLE_CHUNK_SIZE particles. In each chunk, the random steering is applied
+//! one particle at a time, then the gravity, acceleration, friction, movement and fade are applied to all the particles
+//! of the chunk at once by the vectorized ParticleKernels. Large bursts are updated on several threads, one chunk at a time
+//! (see WorkStealingPool). Removing the dead particles and updating the bounding rect stay on the thread of the scene.
+//!
+//! The particles don't collide with anything. The particle positions are stored in the coordinates of the emitter,
+//! whose bounding rect covers all of its particles. The emitter is only registered for the tick while it has particles.
+//!
+//! The emitter is a single graphics item : all its particles are drawn by one QPainter::drawPixmapFragments call,
+//! each fragment with the opacity, scale and rotation of its particle. The cost of painting an emitter therefore
+//! barely depends on its number of particles.
+//!
+//! The emitter itself doesn't move, so the scene can't interpolate it with a render offset like the other sprites.
+//! It declares the SelfInterpolatedCapability instead : paint draws each particle between its position at the start
+//! and at the end of the last tick, according to GameScene::renderProgress(), and the scene redraws the emitter
+//! each time the render progress changes.
+//!
+//! The random numbers come from a FastRandom owned by the emitter. It is seeded randomly, unless a seed
+//! is given with setRandomSeed() : the same seed and the same spawns then always give the same particles.
+//! On each tick, the emitter draws a seed from it, and each chunk draws from its own stream of that seed,
+//! whatever the thread that updates the chunk.
+class ParticleEmitter : public Sprite {
+
+    Q_OBJECT
+
+public:
+    enum ParticleType {
+        DEFAULT,
+        EXPLOSIVE,
+        SMOKE,
+        DUST,
+        TRAVEL
+    };
+
+    explicit ParticleEmitter(const QString& rImagePath, QGraphicsItem* pParent = nullptr);
+
+    void setParentScene(GameScene* pScene) override;
+
+    void spawnParticles(ParticleType type, QPointF scenePosition, int count);
+    void clearParticles();
+    [[nodiscard]] inline int particleCount() const { return static_cast<int>(m_types.size()); }
+
+    void setTravelTarget(Sprite* pTarget);
+    void setRandomSeed(quint64 seed);
+
+    // Modifiers
+    float randomisation = 0.25f;
+    float initialSpeed = 5.0f;
+    float fadeTime = 2.0f;
+    float acceleration = 0;
+    float friction = 0;
+    float spinSpeed = 0;    // In degrees per second
+    qreal particleScale = 1;
+
+    [[nodiscard]] QRectF localBoundingRect() const override;
+    void paint(QPainter* pPainter, const QStyleOptionGraphicsItem* pOption, QWidget* pWidget) override;
+
+    void tick(long long elapsedTimeInMilliseconds) override;
+
+private:
+    //! The data shared by all the chunks of particles during a tick.
+    struct ChunkTickContext {
+        float elapsedTime;              // In milliseconds
+        quint64 seed;                   // Seed of the random numbers of the tick, one stream per chunk
+        bool hasTravelTarget;
+        QPointF travelTargetPosition;   // In the coordinates of the emitter
+        ParticleKernels::InstructionSet instructionSet; // Resolved on the thread of the scene
+    };
+
+    static constexpr int PARTICLE_CHUNK_SIZE = 1024;     // Particles updated together, with one random stream
+    static constexpr int PARALLEL_PARTICLE_COUNT = 4096; // Number of particles from which the chunks are updated in parallel
+
+    static constexpr float DEFAULT_GRAVITY = -9.81f; // Same as PhysicsEntity
+    static constexpr float SMOKE_GRAVITY = 0.5f;
+    static constexpr float DUST_GRAVITY = -0.5f;
+
+    QPixmap m_particlePixmap;
+    QPointer<Sprite> m_pTravelTarget;
+    QRectF m_particlesRect;
+    FastRandom m_random;
+    float m_lastTickDuration = 0;   // In milliseconds, to draw the particles between the last two ticks
+
+    // Particles, one entry per particle in each list
+    QList<float> m_positionsX;
+    QList<float> m_positionsY;
+    QList<float> m_velocitiesX;
+    QList<float> m_velocitiesY;
+    QList<float> m_ages;            // Time since the particle was spawned, in milliseconds
+    QList<float> m_lifetimes;       // In milliseconds
+    QList<float> m_opacities;
+    QList<float> m_gravities;
+    QList<float> m_accelerations;   // Along the velocity
+    QList<float> m_fadeRates;       // Opacity lost per millisecond, 0 for the types that don't fade
+    QList<float> m_rotations;       // In degrees
+    QList<float> m_randomisations;  // Randomisation of the steering
+    QList<float> m_travelSpeeds;    // Speed at which TRAVEL particles chase the target, 0 for the other types
+    QList<float> m_travelLerpRates; // Part of the velocity of TRAVEL particles turned towards the target per second
+    QList<quint8> m_types;          // ParticleType
+
+    QList<QPainter::PixmapFragment> m_fragments; // Fragments drawn by paint, kept to reuse their memory
+
+    void tickChunk(int chunkIndex, const ChunkTickContext& rContext);
+    void steerParticles(int begin, int end, const ChunkTickContext& rContext, FastRandom& rRandom);
+    void spinParticles(int begin, int end, float elapsedTimeInMilliseconds);
+    void removeDeadParticles();
+    void removeParticle(int index);
+    void updateParticlesRect();
+    [[nodiscard]] float previousStepDuration(int index) const;
+
+    void randomizeDirection(float& rX, float& rY, float particleRandomisation, FastRandom& rRandom) const;
+    [[nodiscard]] float randomOffset(float range, FastRandom& rRandom) const;
+};
+
+
+#endif //INC_2023_JCO_AIRTIME_PARTICLEEMITTER_H
@@ -0,0 +1,324 @@
+//
+// Created by blatnoa on 12.06.2023.
+//
+
+#include "ParticleKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+// SSE2 is part of every x86-64 processor. AVX2 is compiled for its own functions only,
+// and used if the processor supports it.
+// GCC can't align the stack to 32 bytes on Windows (GCC bug 54412) : the __m256 locals that a build without
+// optimisations spills to the stack would be stored with aligned instructions at misaligned addresses.
+// The AVX2 kernels are therefore left out of Windows builds (MinGW), which use the SSE kernels.
+#if defined(__SSE2__) || defined(_M_X64)
+    #define PARTICLE_KERNELS_SSE
+    #include <immintrin.h>
+    #if (defined(__GNUC__) || defined(__clang__)) && !defined(_WIN32)
+        #define PARTICLE_KERNELS_AVX2
+        #define AVX2_FUNCTION __attribute__((target("avx2")))
+    #endif
+#endif
+
+ParticleKernels::InstructionSet ParticleKernels::s_instructionSet = ParticleKernels::SCALAR;
+bool ParticleKernels::s_isInstructionSetDetected = false;
+
+// Scalar kernels, also used for the particles left over by the vectorized kernels
+
+static void accelerateScalar(float* pVelocitiesX, float* pVelocitiesY, const float* pGravities, const float* pAccelerations,
+                             int begin, int end, float frictionFactor, float elapsedTimeInSeconds) {
+    for (int i = begin; i < end; i++) {
+        float velocityX = pVelocitiesX[i];
+        float velocityY = pVelocitiesY[i];
+
+        // Acceleration along the normalized velocity
+        float length = std::sqrt(velocityX * velocityX + velocityY * velocityY);
+        if (length > 0) {
+            float accelerationFactor = pAccelerations[i] * elapsedTimeInSeconds / length;
+            velocityX += velocityX * accelerationFactor;
+            velocityY += velocityY * accelerationFactor;
+        }
+
+        velocityY -= pGravities[i] * elapsedTimeInSeconds;
+
+        pVelocitiesX[i] = velocityX * frictionFactor;
+        pVelocitiesY[i] = velocityY * frictionFactor;
+    }
+}
+
+static void integratePositionsScalar(float* pPositionsX, float* pPositionsY, const float* pVelocitiesX, const float* pVelocitiesY,
+                                     int begin, int end, float elapsedTimeInMilliseconds) {
+    for (int i = begin; i < end; i++) {
+        pPositionsX[i] += pVelocitiesX[i] * elapsedTimeInMilliseconds;
+        pPositionsY[i] += pVelocitiesY[i] * elapsedTimeInMilliseconds;
+    }
+}
+
+static void fadeScalar(float* pAges, float* pOpacities, const float* pFadeRates, int begin, int end, float elapsedTimeInMilliseconds) {
+    for (int i = begin; i < end; i++) {
+        pAges[i] += elapsedTimeInMilliseconds;
+        pOpacities[i] = std::max(1.0f - pAges[i] * pFadeRates[i], 0.0f);
+    }
+}
+
+#ifdef PARTICLE_KERNELS_SSE
+
+// SSE kernels, 4 particles at a time. Return the index of the first particle left over.
+
+static int accelerateSse(float* pVelocitiesX, float* pVelocitiesY, const float* pGravities, const float* pAccelerations,
+                         int count, float frictionFactor, float elapsedTimeInSeconds) {
+    const __m128 elapsedTime = _mm_set1_ps(elapsedTimeInSeconds);
+    const __m128 friction = _mm_set1_ps(frictionFactor);
+    const __m128 zero = _mm_setzero_ps();
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 velocityX = _mm_loadu_ps(pVelocitiesX + i);
+        __m128 velocityY = _mm_loadu_ps(pVelocitiesY + i);
+
+        __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(velocityX, velocityX), _mm_mul_ps(velocityY, velocityY)));
+        __m128 accelerationFactor = _mm_div_ps(_mm_mul_ps(_mm_loadu_ps(pAccelerations + i), elapsedTime), length);
+        accelerationFactor = _mm_and_ps(accelerationFactor, _mm_cmpgt_ps(length, zero)); // No direction, no acceleration
+        velocityX = _mm_add_ps(velocityX, _mm_mul_ps(velocityX, accelerationFactor));
+        velocityY = _mm_add_ps(velocityY, _mm_mul_ps(velocityY, accelerationFactor));
+
+        velocityY = _mm_sub_ps(velocityY, _mm_mul_ps(_mm_loadu_ps(pGravities + i), elapsedTime));
+
+        _mm_storeu_ps(pVelocitiesX + i, _mm_mul_ps(velocityX, friction));
+        _mm_storeu_ps(pVelocitiesY + i, _mm_mul_ps(velocityY, friction));
+    }
+    return i;
+}
+
+static int integratePositionsSse(float* pPositionsX, float* pPositionsY, const float* pVelocitiesX, const float* pVelocitiesY,
+                                 int count, float elapsedTimeInMilliseconds) {
+    const __m128 elapsedTime = _mm_set1_ps(elapsedTimeInMilliseconds);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 positionX = _mm_add_ps(_mm_loadu_ps(pPositionsX + i), _mm_mul_ps(_mm_loadu_ps(pVelocitiesX + i), elapsedTime));
+        __m128 positionY = _mm_add_ps(_mm_loadu_ps(pPositionsY + i), _mm_mul_ps(_mm_loadu_ps(pVelocitiesY + i), elapsedTime));
+        _mm_storeu_ps(pPositionsX + i, positionX);
+        _mm_storeu_ps(pPositionsY + i, positionY);
+    }
+    return i;
+}
+
+static int fadeSse(float* pAges, float* pOpacities, const float* pFadeRates, int count, float elapsedTimeInMilliseconds) {
+    const __m128 elapsedTime = _mm_set1_ps(elapsedTimeInMilliseconds);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 zero = _mm_setzero_ps();
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 age = _mm_add_ps(_mm_loadu_ps(pAges + i), elapsedTime);
+        __m128 opacity = _mm_max_ps(_mm_sub_ps(one, _mm_mul_ps(age, _mm_loadu_ps(pFadeRates + i))), zero);
+        _mm_storeu_ps(pAges + i, age);
+        _mm_storeu_ps(pOpacities + i, opacity);
+    }
+    return i;
+}
+
+#endif
+
+#ifdef PARTICLE_KERNELS_AVX2
+
+// AVX2 kernels, 8 particles at a time. Return the index of the first particle left over.
+
+AVX2_FUNCTION static int accelerateAvx2(float* pVelocitiesX, float* pVelocitiesY, const float* pGravities, const float* pAccelerations,
+                                        int count, float frictionFactor, float elapsedTimeInSeconds) {
+    const __m256 elapsedTime = _mm256_set1_ps(elapsedTimeInSeconds);
+    const __m256 friction = _mm256_set1_ps(frictionFactor);
+    const __m256 zero = _mm256_setzero_ps();
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 velocityX = _mm256_loadu_ps(pVelocitiesX + i);
+        __m256 velocityY = _mm256_loadu_ps(pVelocitiesY + i);
+
+        __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(velocityX, velocityX), _mm256_mul_ps(velocityY, velocityY)));
+        __m256 accelerationFactor = _mm256_div_ps(_mm256_mul_ps(_mm256_loadu_ps(pAccelerations + i), elapsedTime), length);
+        accelerationFactor = _mm256_and_ps(accelerationFactor, _mm256_cmp_ps(length, zero, _CMP_GT_OQ)); // No direction, no acceleration
+        velocityX = _mm256_add_ps(velocityX, _mm256_mul_ps(velocityX, accelerationFactor));
+        velocityY = _mm256_add_ps(velocityY, _mm256_mul_ps(velocityY, accelerationFactor));
+
+        velocityY = _mm256_sub_ps(velocityY, _mm256_mul_ps(_mm256_loadu_ps(pGravities + i), elapsedTime));
+
+        _mm256_storeu_ps(pVelocitiesX + i, _mm256_mul_ps(velocityX, friction));
+        _mm256_storeu_ps(pVelocitiesY + i, _mm256_mul_ps(velocityY, friction));
+    }
+    return i;
+}
+
+AVX2_FUNCTION static int integratePositionsAvx2(float* pPositionsX, float* pPositionsY, const float* pVelocitiesX, const float* pVelocitiesY,
+                                                int count, float elapsedTimeInMilliseconds) {
+    const __m256 elapsedTime = _mm256_set1_ps(elapsedTimeInMilliseconds);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 positionX = _mm256_add_ps(_mm256_loadu_ps(pPositionsX + i), _mm256_mul_ps(_mm256_loadu_ps(pVelocitiesX + i), elapsedTime));
+        __m256 positionY = _mm256_add_ps(_mm256_loadu_ps(pPositionsY + i), _mm256_mul_ps(_mm256_loadu_ps(pVelocitiesY + i), elapsedTime));
+        _mm256_storeu_ps(pPositionsX + i, positionX);
+        _mm256_storeu_ps(pPositionsY + i, positionY);
+    }
+    return i;
+}
+
+AVX2_FUNCTION static int fadeAvx2(float* pAges, float* pOpacities, const float* pFadeRates, int count, float elapsedTimeInMilliseconds) {
+    const __m256 elapsedTime = _mm256_set1_ps(elapsedTimeInMilliseconds);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 zero = _mm256_setzero_ps();
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 age = _mm256_add_ps(_mm256_loadu_ps(pAges + i), elapsedTime);
+        __m256 opacity = _mm256_max_ps(_mm256_sub_ps(one, _mm256_mul_ps(age, _mm256_loadu_ps(pFadeRates + i))), zero);
+        _mm256_storeu_ps(pAges + i, age);
+        _mm256_storeu_ps(pOpacities + i, opacity);
+    }
+    return i;
+}
+
+#endif
+
+//! Returns the fastest instruction set supported by the processor.
+//! \return The best instruction set.
+ParticleKernels::InstructionSet ParticleKernels::bestInstructionSet() {
+#ifdef PARTICLE_KERNELS_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        return AVX2;
+    }
+#endif
+#ifdef PARTICLE_KERNELS_SSE
+    return SSE;
+#else
+    return SCALAR;
+#endif
+}
+
+//! Returns the instruction set to pass to the kernels.
+//! It is the best one supported by the processor, unless a slower one was forced by setInstructionSet().
+//! Must only be called from the thread of the scene, as the first call detects the instruction set.
+//! \return The instruction set in use.
+ParticleKernels::InstructionSet ParticleKernels::instructionSet() {
+    if (!s_isInstructionSetDetected) {
+        s_instructionSet = bestInstructionSet();
+        s_isInstructionSetDetected = true;
+    }
+    return s_instructionSet;
+}
+
+//! Forces the instruction set used by the kernels.
+//! An instruction set that the processor doesn't support is replaced by the best supported one.
+//! Must only be called from the thread of the scene.
+//! \param instructionSet The instruction set to use.
+void ParticleKernels::setInstructionSet(InstructionSet instructionSet) {
+    s_instructionSet = std::min(instructionSet, bestInstructionSet());
+    s_isInstructionSetDetected = true;
+}
+
+//! Returns the name of an instruction set, for the logs.
+//! \param instructionSet The instruction set.
+//! \return The name of the instruction set.
+const char* ParticleKernels::instructionSetName(InstructionSet instructionSet) {
+    switch (instructionSet) {
+        case AVX2:
+            return "AVX2";
+        case SSE:
+            return "SSE";
+        default:
+            return "scalar";
+    }
+}
+
+//! Applies the acceleration along the normalized velocity, the gravity and the friction to each particle.
+//! \param pVelocitiesX The x velocities, in pixels per millisecond.
+//! \param pVelocitiesY The y velocities, in pixels per millisecond.
+//! \param pGravities The gravity of each particle. A negative gravity pulls the particle down.
+//! \param pAccelerations The acceleration of each particle, along its velocity.
+//! \param count The number of particles.
+//! \param friction The friction, shared by all the particles.
+//! \param elapsedTimeInMilliseconds The elapsed time in milliseconds.
+//! \param instructionSet The instruction set to use (see instructionSet()).
+void ParticleKernels::accelerate(float* pVelocitiesX, float* pVelocitiesY, const float* pGravities, const float* pAccelerations,
+                                 int count, float friction, float elapsedTimeInMilliseconds, InstructionSet instructionSet) {
+    const float elapsedTimeInSeconds = elapsedTimeInMilliseconds / 1000.0f;
+    const float frictionFactor = 1 - friction * elapsedTimeInSeconds;
+
+    int begin = 0;
+    switch (instructionSet) {
+#ifdef PARTICLE_KERNELS_AVX2
+        case AVX2:
+            begin = accelerateAvx2(pVelocitiesX, pVelocitiesY, pGravities, pAccelerations, count, frictionFactor, elapsedTimeInSeconds);
+            break;
+#endif
+#ifdef PARTICLE_KERNELS_SSE
+        case SSE:
+            begin = accelerateSse(pVelocitiesX, pVelocitiesY, pGravities, pAccelerations, count, frictionFactor, elapsedTimeInSeconds);
+            break;
+#endif
+        default:
+            break;
+    }
+
+    accelerateScalar(pVelocitiesX, pVelocitiesY, pGravities, pAccelerations, begin, count, frictionFactor, elapsedTimeInSeconds);
+}
+
+//! Moves each particle by its velocity.
+//! \param pPositionsX The x positions.
+//! \param pPositionsY The y positions.
+//! \param pVelocitiesX The x velocities, in pixels per millisecond.
+//! \param pVelocitiesY The y velocities, in pixels per millisecond.
+//! \param count The number of particles.
+//! \param elapsedTimeInMilliseconds The elapsed time in milliseconds.
+//! \param instructionSet The instruction set to use (see instructionSet()).
+void ParticleKernels::integratePositions(float* pPositionsX, float* pPositionsY, const float* pVelocitiesX, const float* pVelocitiesY,
+                                         int count, float elapsedTimeInMilliseconds, InstructionSet instructionSet) {
+    int begin = 0;
+    switch (instructionSet) {
+#ifdef PARTICLE_KERNELS_AVX2
+        case AVX2:
+            begin = integratePositionsAvx2(pPositionsX, pPositionsY, pVelocitiesX, pVelocitiesY, count, elapsedTimeInMilliseconds);
+            break;
+#endif
+#ifdef PARTICLE_KERNELS_SSE
+        case SSE:
+            begin = integratePositionsSse(pPositionsX, pPositionsY, pVelocitiesX, pVelocitiesY, count, elapsedTimeInMilliseconds);
+            break;
+#endif
+        default:
+            break;
+    }
+
+    integratePositionsScalar(pPositionsX, pPositionsY, pVelocitiesX, pVelocitiesY, begin, count, elapsedTimeInMilliseconds);
+}
+
+//! Ages each particle and updates its opacity : the opacity goes from 1 to 0 as age * fade rate goes from 0 to 1.
+//! A particle with a fade rate of 0 stays opaque.
+//! \param pAges The ages, in milliseconds.
+//! \param pOpacities The opacities.
+//! \param pFadeRates The fade rate of each particle, per millisecond.
+//! \param count The number of particles.
+//! \param elapsedTimeInMilliseconds The elapsed time in milliseconds.
+//! \param instructionSet The instruction set to use (see instructionSet()).
+void ParticleKernels::fade(float* pAges, float* pOpacities, const float* pFadeRates, int count, float elapsedTimeInMilliseconds,
+                           InstructionSet instructionSet) {
+    int begin = 0;
+    switch (instructionSet) {
+#ifdef PARTICLE_KERNELS_AVX2
+        case AVX2:
+            begin = fadeAvx2(pAges, pOpacities, pFadeRates, count, elapsedTimeInMilliseconds);
+            break;
+#endif
+#ifdef PARTICLE_KERNELS_SSE
+        case SSE:
+            begin = fadeSse(pAges, pOpacities, pFadeRates, count, elapsedTimeInMilliseconds);
+            break;
+#endif
+        default:
+            break;
+    }
+
+    fadeScalar(pAges, pOpacities, pFadeRates, begin, count, elapsedTimeInMilliseconds);
+}
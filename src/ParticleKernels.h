@@ -0,0 +1,54 @@
+/**
+\file     ParticleKernels.h
+\brief    Déclaration de la classe ParticleKernels.
+\author   Blattner Noah
+\date     juin 2023
+*/
+
+#ifndef INC_2023_JCO_AIRTIME_PARTICLEKERNELS_H
+#define INC_2023_JCO_AIRTIME_PARTICLEKERNELS_H
+
+//! \brief Vectorized loops that step whole batches of particles at once.
+//!
+//! The kernels work on the arrays of a ParticleEmitter (one array per property) and process
+//! 8 particles per instruction with AVX2, 4 with SSE, or one at a time with the scalar fallback.
+//! AVX2 isn't available in Windows builds, whose compiler can't align the AVX2 values on the stack.
+//! The best instruction set supported by the processor is detected on the first call to instructionSet().
+//! setInstructionSet() can force a slower one, for example to compare them in a benchmark.
+//! Both must only be called from the thread of the scene. The kernels don't read the instruction set themselves :
+//! it is resolved once by their caller and passed to each call, so the kernels can run on several threads at once.
+//!
+//! The kernels are :
+//!     - accelerate: Applies the acceleration along the normalized velocity, the gravity and the friction.
+//!     - integratePositions: Moves each particle by its velocity.
+//!     - fade: Ages each particle and fades it out according to its fade rate.
+//! They follow the same formulas as PhysicsEntity. The velocities are in pixels per millisecond,
+//! the gravity, acceleration and friction per second, like for a PhysicsEntity.
+class ParticleKernels {
+
+public:
+    enum InstructionSet {
+        SCALAR,
+        SSE,
+        AVX2
+    };
+
+    static InstructionSet bestInstructionSet();
+    static InstructionSet instructionSet();
+    static void setInstructionSet(InstructionSet instructionSet);
+    static const char* instructionSetName(InstructionSet instructionSet);
+
+    static void accelerate(float* pVelocitiesX, float* pVelocitiesY, const float* pGravities, const float* pAccelerations,
+                           int count, float friction, float elapsedTimeInMilliseconds, InstructionSet instructionSet);
+    static void integratePositions(float* pPositionsX, float* pPositionsY, const float* pVelocitiesX, const float* pVelocitiesY,
+                                   int count, float elapsedTimeInMilliseconds, InstructionSet instructionSet);
+    static void fade(float* pAges, float* pOpacities, const float* pFadeRates, int count, float elapsedTimeInMilliseconds,
+                     InstructionSet instructionSet);
+
+private:
+    static InstructionSet s_instructionSet;
+    static bool s_isInstructionSetDetected;
+};
+
+
+#endif //INC_2023_JCO_AIRTIME_PARTICLEKERNELS_H
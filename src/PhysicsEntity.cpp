@@ -7,12 +7,15 @@
 #include "GameScene.h"
 #include "DirectionalEntityCollider.h"
 
-PhysicsEntity::PhysicsEntity(QGraphicsItem* pParent) : AdvancedCollisionSprite(pParent) {
+#include <algorithm>
+#include <limits>
 
+PhysicsEntity::PhysicsEntity(QGraphicsItem* pParent) : AdvancedCollisionSprite(pParent) {
+    addCapability(PhysicsCapability);
 };
 
 PhysicsEntity::PhysicsEntity(const QString &rImagePath, QGraphicsItem* pParent) : AdvancedCollisionSprite(rImagePath, pParent) {
-
+    addCapability(PhysicsCapability);
 };
 
 //! Set the parent scene.
@@ -21,8 +24,12 @@ PhysicsEntity::PhysicsEntity(const QString &rImagePath, QGraphicsItem* pParent)
 void PhysicsEntity::setParentScene(GameScene *pScene) {
     Sprite::setParentScene(pScene);
 
-    // Register the player for ticks
-    registerForTick();
+    // The entity starts awake in its new scene
+    m_isSleeping = false;
+    m_restTime = 0;
+
+    // Register the entity for ticks, in the phase in which it moves
+    registerForTick(tickPhase());
 }
 
 //! Tick handler :
@@ -47,44 +54,207 @@ void PhysicsEntity::tick(long long elapsedTimeInMilliseconds) {
     move(velocity() * elapsedTimeInMilliseconds);
 }
 
+//! Phase tick handler :
+//! After the entity moved in its tick phase, checks if it stayed at rest long enough to fall asleep.
+//! \param phase The current tick phase.
+//! \param elapsedTimeInMilliseconds The elapsed time in milliseconds.
+void PhysicsEntity::phaseTick(TickPhase phase, long long elapsedTimeInMilliseconds) {
+    AdvancedCollisionSprite::phaseTick(phase, elapsedTimeInMilliseconds);
+
+    if (phase == tickPhase()) {
+        updateSleep(elapsedTimeInMilliseconds);
+    }
+}
+
+//! Set the velocity of the entity.
+//! Wakes the entity up if the velocity changes.
+//! \param velocity The new velocity.
+void PhysicsEntity::setVelocity(QVector2D velocity) {
+    if (velocity == velocityVector) {
+        return;
+    }
+
+    velocityVector = velocity;
+    wakeUp();
+}
+
+//! Enable or disable gravity.
+//! Wakes the entity up if gravity is enabled or disabled.
+//! \param enabled Whether gravity is enabled.
+void PhysicsEntity::setGravityEnabled(bool enabled) {
+    if (enabled == gravityEnabled) {
+        return;
+    }
+
+    gravityEnabled = enabled;
+    wakeUp();
+}
+
+//! Wakes the entity up : it registers for the tick again.
+//! Does nothing if the entity is awake.
+void PhysicsEntity::wakeUp() {
+    if (!m_isSleeping) {
+        return;
+    }
+
+    m_isSleeping = false;
+    m_restTime = 0;
+    if (m_pParentScene != nullptr) {
+        registerForTick(tickPhase());
+    }
+}
+
+//! Checks if the entity is at rest : it barely moves and nothing makes it fall.
+//! Can be overridden by entities that have other reasons to move.
+//! \return True if the entity is at rest.
+bool PhysicsEntity::isAtRest() const {
+    return velocityVector.lengthSquared() <= SLEEP_VELOCITY * SLEEP_VELOCITY && (m_isOnGround || !gravityEnabled);
+}
+
+//! Counts the time spent at rest and puts the entity to sleep after SLEEP_DELAY.
+//! \param elapsedTimeInMilliseconds The elapsed time in milliseconds.
+void PhysicsEntity::updateSleep(long long elapsedTimeInMilliseconds) {
+    if (m_isSleeping) {
+        return;
+    }
+
+    if (!isAtRest()) {
+        m_restTime = 0;
+        return;
+    }
+
+    m_restTime += elapsedTimeInMilliseconds;
+    if (m_restTime >= SLEEP_DELAY) {
+        fallAsleep();
+    }
+}
+
+//! Puts the entity to sleep : it stops and unregisters from its tick phase.
+void PhysicsEntity::fallAsleep() {
+    m_isSleeping = true;
+    velocityVector = QVector2D(0, 0);
+    unregisterFromTick(tickPhase());
+}
+
+//! Wakes up the sleeping entities among the given sprites.
+//! \param candidates The sprites touching the movement of the entity.
+void PhysicsEntity::wakeTouchingEntities(const QList<Sprite*>& candidates) {
+    for (Sprite* pSprite : candidates) {
+        if (pSprite != this && pSprite->hasCapability(PhysicsCapability)) {
+            auto* pEntity = static_cast<PhysicsEntity*>(pSprite);
+            if (pEntity->isSleeping()) {
+                pEntity->wakeUp();
+            }
+        }
+    }
+}
+
+//! Override of the itemChange function.
+//! A sleeping entity doesn't move by itself : if it is moved, it is moved from outside and wakes up.
+//! \param change The change of the item.
+//! \param rValue The value of the change.
+//! \return The value returned by the parent function.
+QVariant PhysicsEntity::itemChange(GraphicsItemChange change, const QVariant& rValue) {
+    if (change == ItemPositionHasChanged && m_isSleeping) {
+        wakeUp();
+    }
+
+    return AdvancedCollisionSprite::itemChange(change, rValue);
+}
+
 //! Move the entity by a given vector.
 //! This movement is blocked by other sprites and the scene boundaries.
+//! The entity stops at the earliest sprite hit along the movement and slides along it.
+//! Triggers crossed along the movement are notified.
 //! \param moveVector The vector to startMove the entity by.
 void PhysicsEntity::move(QVector2D moveVector) {
     if (moveVector.isNull()) { // If the startMove vector is null, do nothing
         return;
     }
 
-    // Calculate the new position
-    m_newRect = collisionRect().translated(moveVector.x(), moveVector.y());
+    QRectF startRect = collisionRect();
+
+    // Calculate the target position, limited to the scene
+    QRectF targetRect = startRect.translated(moveVector.x(), moveVector.y());
+    limitRectToScene(targetRect);
+
+    // A single query for the whole movement and the ground check that follows it :
+    // every position along the movement is inside the swept rect, and the ground probe of the
+    // final position is inside the swept rect moved down by GROUNDED_DISTANCE.
+    // The swept rect grown by GROUNDED_DISTANCE finds the sleeping entities touched by the movement.
+    QRectF sweptRect = startRect | targetRect;
+    QList<QRectF> queryRects = {sweptRect, sweptRect.translated(0, GROUNDED_DISTANCE),
+                                sweptRect.adjusted(-GROUNDED_DISTANCE, -GROUNDED_DISTANCE,
+                                                   GROUNDED_DISTANCE, GROUNDED_DISTANCE)};
+    auto candidateLists = queryCollisionCandidates(queryRects);
+    auto candidates = filterCollidingSprites(candidateLists.at(0));
+
+    // The ground candidates are only filtered by reevaluateGrounded, once the velocity is updated
+    m_groundProbeCandidates = candidateLists.at(1);
+    m_groundProbeRect = queryRects.at(1);
+    m_hasGroundProbe = true;
+
+    // Move the rect until the earliest hit, then slide along the hit sprites
+    QList<AdvancedCollisionSprite*> hitSprites;
+    m_newRect = startRect;
+    sweepRect(m_newRect, QVector2D(targetRect.topLeft() - startRect.topLeft()), candidates, hitSprites);
 
     // Limit the rect to the scene
     limitRectToScene(m_newRect);
 
-    // Check for intersections with other sprites
-    reevaluateIntersects(m_newRect);
+    // Notify the crossed triggers and the hit sprites, and resolve the remaining intersections
+    QRectF pathRect = startRect | m_newRect;
+    foreach (AdvancedCollisionSprite* pSprite, candidates) {
+        if (pSprite->getIsTrigger()) { // If the other sprite is a trigger
+            if (pSprite->globalBoundingRect().intersects(pathRect)) {
+                pSprite->onTrigger(this);
+            }
+        } else if (hitSprites.contains(pSprite) || pSprite->globalBoundingRect().intersects(m_newRect)) {
+            onCollision(pSprite);
+        }
+    }
 
     // Translate the entity to the new position
     setPos(pos() + m_newRect.topLeft() - collisionRect().topLeft());
 
-    // Reevaluate if the entity is on the ground
+    // Entities resting against the entity (on top of a moving platform, for example) must follow the movement
+    if (m_newRect.topLeft() != startRect.topLeft()) {
+        wakeTouchingEntities(candidateLists.at(2));
+    }
+
+    // Reevaluate if the entity is on the ground, with the candidates of the ground probe
     reevaluateGrounded();
+    m_hasGroundProbe = false;
+    m_groundProbeCandidates.clear();
+}
+
+//! Returns the rect the entity may cover during the next tick, used by the broad phase of the scene.
+//! The current rect is swept along the current velocity, with a margin for the ground check
+//! and for the velocity changes applied during the tick.
+//! If the entity ends up outside of this rect, the scene falls back to its spatial grid.
+//! \param elapsedTimeInMilliseconds The duration of the next tick.
+//! \return The rect the entity may cover during the next tick.
+QRectF PhysicsEntity::broadPhaseRect(long long elapsedTimeInMilliseconds) const {
+    QRectF currentRect = globalBoundingRect() | collisionRect();
+    QVector2D displacement = velocityVector * elapsedTimeInMilliseconds;
+
+    QRectF sweptRect = currentRect | currentRect.translated(displacement.toPointF());
+    return sweptRect.adjusted(-BROAD_PHASE_MARGIN, -BROAD_PHASE_MARGIN, BROAD_PHASE_MARGIN, BROAD_PHASE_MARGIN);
 }
 
-//! Returns a list of sprites that the sprite is colliding with.
-//! Only returns sprites that are in the colliding classes list.
-//! And only returns directional entity colliders that are currently blocking the entity.
-//! \param rect The rect to check for intersections with. If empty, uses the current scene bounding rect of the sprite.
-//! \return A list of sprites that the sprite is colliding with.
-QList<AdvancedCollisionSprite*> PhysicsEntity::getCollidingSprites(QRectF rectF) const {
-    auto collidingSprites = AdvancedCollisionSprite::getCollidingSprites(rectF);
+//! Keeps the candidates the entity collides with.
+//! Only keeps sprites that are in the colliding classes list.
+//! And only keeps directional entity colliders that are currently blocking the entity.
+//! \param candidates The candidate sprites, as returned by the scene.
+//! \return The sprites that the entity is colliding with.
+QList<AdvancedCollisionSprite*> PhysicsEntity::filterCollidingSprites(const QList<Sprite*>& candidates) const {
+    auto collidingSprites = AdvancedCollisionSprite::filterCollidingSprites(candidates);
 
     // Remove directional entity colliders that are not blocking the entity
     foreach (auto* pSprite, collidingSprites) {
-        auto pCollider = dynamic_cast<DirectionalEntityCollider*>(pSprite);
-
         // If the collider is not blocking the entity, remove it from the list
-        if (pCollider && !pCollider->isEntityBlocked(this)) {
+        if (pSprite->hasCapability(DirectionalColliderCapability)
+            && !static_cast<DirectionalEntityCollider*>(pSprite)->isEntityBlocked(this)) {
             collidingSprites.removeOne(pSprite);
         }
     }
@@ -118,34 +288,171 @@ void PhysicsEntity::alignRectToSprite(QRectF &rect, Sprite* pSprite) {
 
         // Find the intersection between the new rect and the sprite
         QRectF intersection = rect.intersected(otherCollisionRect);
+        if (intersection.isEmpty()) { // If the rect only touches the sprite (for example after a swept movement)
+            return;
+        }
+
         if (intersection.width() < intersection.height() && intersection.height() > STEP_HEIGHT) { // If the intersection is wider than it is tall
             if (x() < pSprite->x()) { // If the entity is to the left of the sprite
                 rect.setX(otherCollisionRect.left() - rect.width());
             } else { // If the entity is to the right of the sprite
                 rect.setX(otherCollisionRect.right());
             }
-            // Remove the x velocity
-            setVelocity(QVector2D(0, velocity().y()));
+            // Remove the x velocity. Written directly : a collision response is not an impulse that wakes the entity
+            velocityVector.setX(0);
         } else { // If the intersection is taller than it is wide
             if (y() < pSprite->y()) { // If the entity is above the sprite
                 rect.setY(otherCollisionRect.top() - rect.height());
             } else { // If the entity is below the sprite
                 rect.setY(otherCollisionRect.bottom());
             }
-            // Remove the y velocity
-            setVelocity(QVector2D(velocity().x(), 0));
+            // Remove the y velocity. Written directly : a collision response is not an impulse that wakes the entity
+            velocityVector.setY(0);
+        }
+    }
+}
+
+//! Moves a rect along a displacement, stopping at the earliest non trigger sprite hit along the way.
+//! After a hit, the blocked component of the displacement and of the velocity is removed,
+//! and the rest of the displacement slides along the hit sprite.
+//! Removing the velocity doesn't wake the entity : otherwise, an entity resting on the ground
+//! would be woken up by its own gravity on every tick and would never fall asleep.
+//! \param rect The reference to the rect to move.
+//! \param displacement The displacement of the rect.
+//! \param candidates The sprites that may be hit. Their collision rects must cover the whole displacement.
+//! \param rHits The list to which the hit sprites are appended.
+void PhysicsEntity::sweepRect(QRectF &rect, QVector2D displacement, const QList<AdvancedCollisionSprite*>& candidates,
+                              QList<AdvancedCollisionSprite*>& rHits) {
+    for (int iteration = 0; iteration < MAX_SWEEP_ITERATIONS && !displacement.isNull(); iteration++) {
+        // Find the earliest hit
+        float hitTime = 1;
+        bool hitOnX = false;
+        AdvancedCollisionSprite* pHitSprite = nullptr;
+
+        foreach (AdvancedCollisionSprite* pSprite, candidates) {
+            if (pSprite->getIsTrigger()) { // Triggers don't block the movement
+                continue;
+            }
+
+            float time;
+            bool onX;
+            if (sweptTimeOfImpact(rect, displacement, pSprite->collisionRect(), time, onX) && time < hitTime) {
+                hitTime = time;
+                hitOnX = onX;
+                pHitSprite = pSprite;
+            }
+        }
+
+        // Move until the hit (or until the end of the displacement)
+        rect.translate((displacement * hitTime).toPointF());
+        if (pHitSprite == nullptr) { // Nothing was hit
+            return;
+        }
+
+        if (!rHits.contains(pHitSprite)) {
+            rHits << pHitSprite;
+        }
+
+        // Slide along the hit sprite with the rest of the displacement
+        displacement *= 1 - hitTime;
+        if (hitOnX) {
+            displacement.setX(0);
+            velocityVector.setX(0);
+        } else {
+            displacement.setY(0);
+            velocityVector.setY(0);
         }
     }
 }
 
+//! Computes the time of impact of a moving rect against a still rect (swept AABB).
+//! Hits on the sides of rects that are low enough to be stepped on (STEP_HEIGHT) are ignored,
+//! they are resolved as an intersection after the movement.
+//! \param rect The moving rect.
+//! \param displacement The displacement of the moving rect.
+//! \param otherRect The still rect.
+//! \param rTime The time of impact, as a fraction of the displacement (between 0 and 1).
+//! \param rHitOnX Set to true if the hit blocks the horizontal movement, false if it blocks the vertical movement.
+//! \return True if the moving rect hits the still rect during the displacement.
+bool PhysicsEntity::sweptTimeOfImpact(const QRectF &rect, QVector2D displacement, const QRectF &otherRect,
+                                      float &rTime, bool &rHitOnX) const {
+    const float infinity = std::numeric_limits<float>::infinity();
+
+    // Times at which the rects start and stop overlapping on each axis
+    float xEntry, xExit, yEntry, yExit;
+
+    if (displacement.x() > 0) {
+        xEntry = (otherRect.left() - rect.right()) / displacement.x();
+        xExit = (otherRect.right() - rect.left()) / displacement.x();
+    } else if (displacement.x() < 0) {
+        xEntry = (otherRect.right() - rect.left()) / displacement.x();
+        xExit = (otherRect.left() - rect.right()) / displacement.x();
+    } else if (rect.right() > otherRect.left() && rect.left() < otherRect.right()) { // Always overlapping on x
+        xEntry = -infinity;
+        xExit = infinity;
+    } else { // Never overlapping on x
+        return false;
+    }
+
+    if (displacement.y() > 0) {
+        yEntry = (otherRect.top() - rect.bottom()) / displacement.y();
+        yExit = (otherRect.bottom() - rect.top()) / displacement.y();
+    } else if (displacement.y() < 0) {
+        yEntry = (otherRect.bottom() - rect.top()) / displacement.y();
+        yExit = (otherRect.top() - rect.bottom()) / displacement.y();
+    } else if (rect.bottom() > otherRect.top() && rect.top() < otherRect.bottom()) { // Always overlapping on y
+        yEntry = -infinity;
+        yExit = infinity;
+    } else { // Never overlapping on y
+        return false;
+    }
+
+    float entry = std::max(xEntry, yEntry);
+    float exit = std::min(xExit, yExit);
+
+    // No hit if the rects never overlap on both axis at the same time, if they already overlap
+    // at the start of the movement, or if they only overlap after the end of the movement
+    if (entry >= exit || entry < 0 || entry >= 1) {
+        return false;
+    }
+
+    rHitOnX = xEntry > yEntry;
+
+    if (rHitOnX) {
+        // Sprites low enough are stepped on instead of blocking the entity
+        float top = rect.top() + displacement.y() * entry;
+        float bottom = rect.bottom() + displacement.y() * entry;
+        float overlapHeight = std::min<float>(bottom, otherRect.bottom()) - std::max<float>(top, otherRect.top());
+        if (overlapHeight <= STEP_HEIGHT) {
+            return false;
+        }
+    }
+
+    rTime = entry;
+    return true;
+}
+
 //! Reevaluate if the entity is on the ground.
 //! This is done by checking if the entity is colliding with another sprite at the bottom.
 //! And if the entity is at the bottom of the scene.
+//! When called by move, reuses the candidates of the ground probe queried along with the movement.
 //! \return True if the entity is on the ground, false otherwise.
 bool PhysicsEntity::reevaluateGrounded() {
     // Check if the player is on the ground
     QRectF groundRect = collisionRect().translated(0, GROUNDED_DISTANCE);
-    auto groundCheckCollisions = getCollidingSprites(groundRect);
+    QList<AdvancedCollisionSprite*> groundCheckCollisions;
+    if (m_hasGroundProbe && m_groundProbeRect.contains(groundRect)) { // If the ground probe of move covers the ground rect
+        QList<Sprite*> groundCandidates;
+        foreach (Sprite* pSprite, m_groundProbeCandidates) {
+            // The candidate may have left the scene during the movement (triggers, collisions)
+            if (m_pParentScene->containsSprite(pSprite) && pSprite->globalBoundingRect().intersects(groundRect)) {
+                groundCandidates << pSprite;
+            }
+        }
+        groundCheckCollisions = filterCollidingSprites(groundCandidates);
+    } else {
+        groundCheckCollisions = getCollidingSprites(groundRect);
+    }
 
     // Remove triggers
     foreach (auto* pSprite, groundCheckCollisions) {
@@ -174,9 +481,8 @@ bool PhysicsEntity::reevaluateGrounded() {
 //! Otherwise, the parent onCollision function is called and the entity is aligned to the other sprite.
 //! \param pOther The other sprite.
 void PhysicsEntity::onCollision(AdvancedCollisionSprite* pOther) {
-    auto* directionalCollider = dynamic_cast<DirectionalEntityCollider*>(pOther);
-    if (directionalCollider != nullptr &&
-        !directionalCollider->isEntityBlocked(this)) { // If the other sprite is a directional entity collider and the entity is not blocked by it
+    if (pOther->hasCapability(DirectionalColliderCapability) &&
+        !static_cast<DirectionalEntityCollider*>(pOther)->isEntityBlocked(this)) { // If the other sprite is a directional entity collider and the entity is not blocked by it
         // Ignore the collision
         return;
     }
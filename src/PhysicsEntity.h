@@ -17,21 +17,31 @@
 //!
 //! This class can be subclassed to create various physics entities such as the player or enemies.
 //!
-//! This class is always automatically registered for ticks when the parent scene is set.
+//! This class is always automatically registered for ticks when the parent scene is set,
+//! in the phase returned by tickPhase() (the physics phase by default).
 //!
 //! The physics entity has a velocity vector that is applied to the entity every tick.
 //! The velocity is affected by gravity and friction.
 //! Gravity is applied by default, but can be disabled.
 //!
 //! On every tick, the entity is moved according to it's velocity vector.
-//! Before moving, the entity checks for collisions with other sprites.
-//! If a collision is detected, the entity is moved to the closest position to the collision point.
+//! The movement is swept : the entity stops at the earliest sprite hit along its movement (time of impact),
+//! and the rest of the movement slides along that sprite. Thin sprites therefore can't be crossed,
+//! whatever the speed of the entity or the duration of the tick.
+//! Sprites that still intersect the entity after the movement are resolved by moving the entity to the closest position.
 //! Collision detection is done using the parent AdvancedCollisionSprite class.
 //!
 //! The isOnGround property is set to true if the entity is on the ground.
 //! The entity is considered to be on the ground if the distance to the ground is less than GROUNDED_DISTANCE constant.
 //! If needed, the isGrounded property can be reevaluated by calling the reevaluateGrounded function at any time.
 //! This is normally not needed, as the isGrounded property is automatically reevaluated every time the entity moves.
+//! The ground probe is queried along with the movement, so a movement only costs a single collision query.
+//!
+//! An entity that stays at rest (see isAtRest()) for SLEEP_DELAY milliseconds falls asleep :
+//! it unregisters from the tick and costs nothing until it is woken up.
+//! The entity wakes up when its velocity or gravity is changed from outside (an impulse, an input...),
+//! when it is moved from outside, or when an awake entity moves against it.
+//! wakeUp() can also be called directly.
 //!
 //! The class always registers for collision events with the DirectionalEntityCollider class.
 //! When a collision with a DirectionalEntityCollider is detected, the entity checks if the collisions is blocking the current direction of movement.
@@ -49,33 +59,56 @@ public:
 
     // Velocity
     [[nodiscard]] inline QVector2D velocity() const { return velocityVector; }
-    inline void addVelocity(QVector2D velocity) { velocityVector += velocity; }
-    inline void setVelocity(QVector2D velocity) { velocityVector = velocity; }
-    inline void setXVelocity(float xVelocity) { velocityVector.setX(xVelocity); }
-    inline void setYVelocity(float yVelocity) { velocityVector.setY(yVelocity); }
+    inline void addVelocity(QVector2D velocity) { setVelocity(velocityVector + velocity); }
+    void setVelocity(QVector2D velocity);
+    inline void setXVelocity(float xVelocity) { setVelocity(QVector2D(xVelocity, velocityVector.y())); }
+    inline void setYVelocity(float yVelocity) { setVelocity(QVector2D(velocityVector.x(), yVelocity)); }
 
     void move(QVector2D moveVector);
 
     // Gravity
     [[nodiscard]] inline bool isGravityEnabled() const { return gravityEnabled; }
-    inline void setGravityEnabled(bool enabled) { gravityEnabled = enabled; }
+    void setGravityEnabled(bool enabled);
+
+    // Sleep
+    [[nodiscard]] inline bool isSleeping() const { return m_isSleeping; }
+    void wakeUp();
 
     // Ground check
     [[nodiscard]] inline bool isOnGround() const { return m_isOnGround; }
     virtual bool reevaluateGrounded();
 
-    [[nodiscard]] QList<AdvancedCollisionSprite*> getCollidingSprites(QRectF rect = QRectF()) const override;
-
     void tick(long long elapsedTimeInMilliseconds) override;
+    void phaseTick(TickPhase phase, long long elapsedTimeInMilliseconds) override;
+    //! The tick phase in which the entity moves.
+    [[nodiscard]] virtual TickPhase tickPhase() const { return PhysicsPhase; }
+
+    [[nodiscard]] QRectF broadPhaseRect(long long elapsedTimeInMilliseconds) const override;
 
 private:
     const float GROUNDED_DISTANCE = 1;
     const int STEP_HEIGHT = 10;
+    const float BROAD_PHASE_MARGIN = 16;
+    const int MAX_SWEEP_ITERATIONS = 3;
+    const float SLEEP_VELOCITY = 0.001f; // Velocity under which the entity is considered at rest, in pixels per millisecond
+    const long long SLEEP_DELAY = 500;   // Time at rest before the entity falls asleep, in milliseconds
 
     bool m_isOnGround = false;
 
     QRectF m_newRect;
 
+    // Candidates of the ground probe, queried by move along with the movement
+    QList<Sprite*> m_groundProbeCandidates;
+    QRectF m_groundProbeRect;
+    bool m_hasGroundProbe = false;
+
+    bool m_isSleeping = false;
+    long long m_restTime = 0; // Time spent at rest since the entity last moved
+
+    void updateSleep(long long elapsedTimeInMilliseconds);
+    void fallAsleep();
+    void wakeTouchingEntities(const QList<Sprite*>& candidates);
+
 protected:
     QVector2D velocityVector = QVector2D(0, 0);
 
@@ -88,7 +121,18 @@ protected:
 
     void alignRectToSprite(QRectF &rect, Sprite* pSprite);
 
+    void sweepRect(QRectF &rect, QVector2D displacement, const QList<AdvancedCollisionSprite*>& candidates,
+                   QList<AdvancedCollisionSprite*>& rHits);
+    [[nodiscard]] bool sweptTimeOfImpact(const QRectF &rect, QVector2D displacement, const QRectF &otherRect,
+                                         float &rTime, bool &rHitOnX) const;
+
+    [[nodiscard]] QList<AdvancedCollisionSprite*> filterCollidingSprites(const QList<Sprite*>& candidates) const override;
+
     void onCollision(AdvancedCollisionSprite* pOther) override;
+
+    [[nodiscard]] virtual bool isAtRest() const;
+
+    QVariant itemChange(GraphicsItemChange change, const QVariant& rValue) override;
 };
 
 
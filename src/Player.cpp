@@ -11,6 +11,12 @@
 #include <QDir>
 #include <QKeyEvent>
 
+const QString Player::PLAYER_COLLISION_TAG = "Player";
+const quint64 Player::PLAYER_LAYER = AdvancedCollisionSprite::layerOf(PLAYER_COLLISION_TAG);
+
+// Collision layer of the sprites that kill the player
+const quint64 KILL_ZONE_LAYER = AdvancedCollisionSprite::layerOf("KillZone");
+
 //! Constructor :
 //! \param gameCore The game core which sends the key events.
 Player::Player(GameCore *gameCore, QGraphicsItem *parent) : PhysicsEntity(parent) {
@@ -19,20 +25,17 @@ Player::Player(GameCore *gameCore, QGraphicsItem *parent) : PhysicsEntity(parent
 
     setZValue(1);
 
+    // The camera follows the player, it must never be suspended
+    setAlwaysActive(true);
+
     // Apply physics overrides
     friction = PLAYER_FRICTION_OVERRIDE;
     gravity = PLAYER_GRAVITY_OVERRIDE;
 
     // Set collisions
-    collisionTag = "Player";
+    setCollisionTag(PLAYER_COLLISION_TAG);
     setCollisionOverride(PLAYER_COLLISION_RECT);
 
-    // Init timer
-    dashTimer.setSingleShot(true);
-    dashTimer.setTimerType(Qt::PreciseTimer);
-    dashTimer.setInterval(PLAYER_DASH_TIME * 1000);
-    connect(&dashTimer, &QTimer::timeout, this, &Player::endDash);
-
     // Connect the key events to the player
     connect(gameCore, &GameCore::notifyKeyPressed, this, &Player::onKeyPressed);
     connect(gameCore, &GameCore::notifyKeyReleased, this, &Player::onKeyReleased);
@@ -91,29 +94,57 @@ void Player::initAnimations() {
     startAnimation();
 }
 
-//! Player tick handler.
-//! Updates the player x velocity based on inputs to make it move.
-//! Updates the animation of the player.
-//! \param elapsedTimeInMilliseconds The elapsed time since the last tick.
-void Player::tick(long long elapsedTimeInMilliseconds) {
-    if (!isDashing) {
-        walk(elapsedTimeInMilliseconds);
-    }
+//! Override of the setParentScene function.
+//! Registers the player for the input and camera phases of the tick, on top of the physics phase.
+//! \param pScene The parent scene.
+void Player::setParentScene(GameScene* pScene) {
+    PhysicsEntity::setParentScene(pScene);
 
-    // Call the parent tick handler which applies the velocity
-    PhysicsEntity::tick(elapsedTimeInMilliseconds);
+    registerForTick(InputPhase);
+    registerForTick(CameraPhase);
+}
 
-    parentScene()->centerViewOn(this);
+//! Tick handler :
+//! Input phase : updates the player x velocity based on inputs to make it move.
+//! Physics phase : the parent tick handler applies the velocity.
+//! Camera phase : centers the view on the player.
+//! \param phase The current tick phase.
+//! \param elapsedTimeInMilliseconds The elapsed time since the last tick.
+void Player::phaseTick(TickPhase phase, long long elapsedTimeInMilliseconds) {
+    switch (phase) {
+        case InputPhase:
+            if (!isDashing) {
+                walk(elapsedTimeInMilliseconds);
+            }
+            break;
+        case CameraPhase:
+            parentScene()->centerViewOn(this);
+            break;
+        default:
+            PhysicsEntity::phaseTick(phase, elapsedTimeInMilliseconds);
+            break;
+    }
 }
 
-//! Override of the onCollision method.
-//! Handles the different event caused by a collision within the player.
-//! \param other The other sprite that collided with this one.
-void Player::onCollision(AdvancedCollisionSprite* other) {
-    PhysicsEntity::onCollision(other);
+//! Override of the isAtRest method.
+//! The player isn't at rest while dashing or while a direction is pressed.
+//! \return True if the player is at rest.
+bool Player::isAtRest() const {
+    return PhysicsEntity::isAtRest() && !isDashing && inputDirection.isNull();
+}
 
-    // If the other is a death zone
-    if (other->collisionTag == "KillZone") {
+//! Override of the onContact method.
+//! Handles the different event caused by a collision within the player, once per collision, after the physics of the tick.
+//! \param pOther The other sprite of the contact.
+//! \param type The kind of intersection that caused the contact.
+//! \param phase Whether the contact begins, stays or ends.
+void Player::onContact(AdvancedCollisionSprite* pOther, ContactEventQueue::ContactType type,
+                       ContactEventQueue::ContactPhase phase) {
+    PhysicsEntity::onContact(pOther, type, phase);
+
+    // If the player starts colliding with a death zone
+    if (phase == ContactEventQueue::ContactBegin && type == ContactEventQueue::CollisionContact
+        && pOther->collisionLayer() == KILL_ZONE_LAYER) {
         // Kill the player
         die();
     }
@@ -223,11 +254,11 @@ void Player::applyWalkInput(long long int elapsedTimeInMilliseconds) {
 
 //! Shows dust particles at the feet of the player.
 void Player::showDustParticles() const {
-    QPoint playerBottomCenter = QPoint(sceneBoundingRect().center().x(), sceneBoundingRect().bottom());
+    QPoint playerBottomCenter = QPoint(globalBoundingRect().center().x(), globalBoundingRect().bottom());
 
-    auto* dust = new AnimatedSprite(dustParticles.toImage(), QList<int>::fromReadOnlyData(DUST_FRAME_DURATIONS));
+    // The dust sprites are reused from the effect pool of the scene
+    AnimatedSprite* dust = parentScene()->effectPool().playEffect(dustParticles, QList<int>::fromReadOnlyData(DUST_FRAME_DURATIONS));
     dust->setPos(playerBottomCenter - QPoint(dust->boundingRect().width() / 2, dust->boundingRect().height()));
-    scene()->addItem(dust);
 }
 
 //! Recharges the dash.
@@ -304,8 +335,9 @@ void Player::dash(QVector2D direction) {
     setGravityEnabled(false);
     friction = 0;
 
-    // Start the timer to end the dash
-    dashTimer.start();
+    // Start the timer to end the dash (restarted if the player was already dashing)
+    cancelScheduled(dashTimerId);
+    dashTimerId = scheduleAfter(PLAYER_DASH_TIME * 1000, [this]() { endDash(); });
 }
 
 //! Ends the dash by removing the dash velocity and re-enabling gravity and friction.
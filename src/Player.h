@@ -25,6 +25,8 @@ class GameCore;
 //! Key events are connected to the player from a GameCore instance to allow the player to move.
 //!
 //! The player is always automatically registered for ticks when the parent scene is set.
+//! Inputs are applied in the input phase, the player moves in the physics phase
+//! and the view follows the player in the camera phase, once every sprite has moved.
 //!
 //! The player's animations are updated according to the current properties of the player.
 //!
@@ -35,6 +37,10 @@ class Player : public PhysicsEntity {
 public:
     explicit Player(GameCore* gamecore, QGraphicsItem* parent = nullptr);
 
+    // Collision tag of the player and its interned layer
+    static const QString PLAYER_COLLISION_TAG;
+    static const quint64 PLAYER_LAYER;
+
     // Player constants
     const QRectF PLAYER_COLLISION_RECT = QRectF(0, 5, 56, 150);
     const float PLAYER_GRAVITY_OVERRIDE = -7;
@@ -46,15 +52,21 @@ public:
     const float PLAYER_STOP_SPEED = .75;
     const float PLAYER_STOP_TIME = .3;
 
-    void tick(long long int elapsedTimeInMilliseconds) override;
+    void setParentScene(GameScene* pScene) override;
+
+    void phaseTick(TickPhase phase, long long int elapsedTimeInMilliseconds) override;
 
-    void onCollision(AdvancedCollisionSprite* pOther) override;
+    void onContact(AdvancedCollisionSprite* pOther, ContactEventQueue::ContactType type,
+                   ContactEventQueue::ContactPhase phase) override;
 
     bool reevaluateGrounded() override;
 
     void rechargeDash();
     inline bool canDash() { return dashEnabled; }
 
+protected:
+    [[nodiscard]] bool isAtRest() const override;
+
 private:
     QVector2D inputDirection = QVector2D(0, 0);
 
@@ -83,7 +95,7 @@ private:
     // Movement
     void jump();
     // Dash
-    QTimer dashTimer;
+    TimerWheel::TimerId dashTimerId = TimerWheel::INVALID_TIMER;
     QVector2D currentDashVector = QVector2D(0, 0);
     bool dashEnabled = true;
     bool isDashing = false;
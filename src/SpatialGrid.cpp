@@ -0,0 +1,156 @@
+//
+// Created by blatnoa on 05.06.2023.
+//
+
+#include "SpatialGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+//! Constructor :
+//! \param cellSize The width and height of a cell, in pixels.
+SpatialGrid::SpatialGrid(qreal cellSize) {
+    m_cellSize = cellSize;
+}
+
+//! Adds a sprite to the grid.
+//! If the sprite is already in the grid, its position is updated instead.
+//! \param pSprite The sprite to add.
+//! \param rRect The scene bounding rect of the sprite.
+void SpatialGrid::insert(Sprite* pSprite, const QRectF& rRect) {
+    if (m_spriteCells.contains(pSprite)) { // If the sprite is already in the grid
+        update(pSprite, rRect);
+        return;
+    }
+
+    CellRange range = cellRange(rRect);
+    m_spriteCells.insert(pSprite, range);
+    addToCells(pSprite, range);
+}
+
+//! Updates the position of a sprite in the grid.
+//! Does nothing if the sprite isn't in the grid or if it still covers the same cells.
+//! \param pSprite The sprite that moved.
+//! \param rRect The new scene bounding rect of the sprite.
+void SpatialGrid::update(Sprite* pSprite, const QRectF& rRect) {
+    auto it = m_spriteCells.find(pSprite);
+    if (it == m_spriteCells.end()) { // If the sprite isn't in the grid
+        return;
+    }
+
+    CellRange newRange = cellRange(rRect);
+    if (newRange == it.value()) { // If the sprite is still in the same cells
+        return;
+    }
+
+    removeFromCells(pSprite, it.value());
+    it.value() = newRange;
+    addToCells(pSprite, newRange);
+}
+
+//! Removes a sprite from the grid.
+//! \param pSprite The sprite to remove.
+void SpatialGrid::remove(Sprite* pSprite) {
+    auto it = m_spriteCells.find(pSprite);
+    if (it == m_spriteCells.end()) { // If the sprite isn't in the grid
+        return;
+    }
+
+    removeFromCells(pSprite, it.value());
+    m_spriteCells.erase(it);
+}
+
+//! Removes all sprites from the grid.
+void SpatialGrid::clear() {
+    m_cells.clear();
+    m_spriteCells.clear();
+    m_oversizedSprites.clear();
+}
+
+//! Appends to the given list the sprites whose cells overlap the given rect.
+//! Each sprite is appended only once, even if it covers several of the queried cells.
+//! \param rRect The rect to query.
+//! \param rResult The list to which the found sprites are appended.
+void SpatialGrid::query(const QRectF& rRect, QList<Sprite*>& rResult) const {
+    rResult << m_oversizedSprites;
+
+    CellRange queryRange = cellRange(rRect);
+    for (int x = queryRange.left; x <= queryRange.right; x++) {
+        for (int y = queryRange.top; y <= queryRange.bottom; y++) {
+            auto it = m_cells.constFind(cellKey(x, y));
+            if (it == m_cells.constEnd()) { // If the cell is empty
+                continue;
+            }
+
+            for (const CellEntry& rEntry : it.value()) {
+                // A sprite covering several queried cells is only reported by the first of them
+                if (x == std::max(rEntry.range.left, queryRange.left)
+                    && y == std::max(rEntry.range.top, queryRange.top)) {
+                    rResult << rEntry.pSprite;
+                }
+            }
+        }
+    }
+}
+
+//! Computes the range of cells covered by a rect.
+//! \param rRect The rect.
+//! \return The range of cells covered by the rect.
+SpatialGrid::CellRange SpatialGrid::cellRange(const QRectF& rRect) const {
+    CellRange range;
+    range.left = static_cast<int>(std::floor(rRect.left() / m_cellSize));
+    range.top = static_cast<int>(std::floor(rRect.top() / m_cellSize));
+    range.right = static_cast<int>(std::floor(rRect.right() / m_cellSize));
+    range.bottom = static_cast<int>(std::floor(rRect.bottom() / m_cellSize));
+    return range;
+}
+
+//! Adds a sprite to all the cells of the given range.
+//! If the range is too big, the sprite is added to the oversized sprites list instead.
+//! \param pSprite The sprite to add.
+//! \param rRange The range of cells covered by the sprite.
+void SpatialGrid::addToCells(Sprite* pSprite, const CellRange& rRange) {
+    if (isOversized(rRange)) {
+        m_oversizedSprites << pSprite;
+        return;
+    }
+
+    for (int x = rRange.left; x <= rRange.right; x++) {
+        for (int y = rRange.top; y <= rRange.bottom; y++) {
+            m_cells[cellKey(x, y)] << CellEntry { pSprite, rRange };
+        }
+    }
+}
+
+//! Removes a sprite from all the cells of the given range.
+//! Uses swap-and-pop, as the order of the sprites within a cell doesn't matter.
+//! \param pSprite The sprite to remove.
+//! \param rRange The range of cells covered by the sprite.
+void SpatialGrid::removeFromCells(Sprite* pSprite, const CellRange& rRange) {
+    if (isOversized(rRange)) {
+        m_oversizedSprites.removeOne(pSprite);
+        return;
+    }
+
+    for (int x = rRange.left; x <= rRange.right; x++) {
+        for (int y = rRange.top; y <= rRange.bottom; y++) {
+            auto it = m_cells.find(cellKey(x, y));
+            if (it == m_cells.end()) {
+                continue;
+            }
+
+            QList<CellEntry>& rEntries = it.value();
+            for (int i = 0; i < rEntries.size(); i++) {
+                if (rEntries[i].pSprite == pSprite) {
+                    rEntries[i] = rEntries.last();
+                    rEntries.removeLast();
+                    break;
+                }
+            }
+
+            if (rEntries.isEmpty()) { // Don't keep empty cells
+                m_cells.erase(it);
+            }
+        }
+    }
+}
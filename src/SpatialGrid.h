@@ -0,0 +1,91 @@
+/**
+\file     SpatialGrid.h
+\brief    Déclaration de la classe SpatialGrid.
+\author   Blattner Noah
+\date     juin 2023
+*/
+
+#ifndef INC_2023_JCO_AIRTIME_SPATIALGRID_H
+#define INC_2023_JCO_AIRTIME_SPATIALGRID_H
+
+#include <QHash>
+#include <QList>
+#include <QRectF>
+
+class Sprite;
+
+//! \brief A uniform grid used to quickly find the sprites located in an area of the scene.
+//!
+//! The scene is divided in square cells of a fixed size.
+//! Each sprite is registered in every cell its bounding rect overlaps.
+//! A rect query then only has to look at the few cells overlapped by the rect,
+//! instead of looking at every sprite of the scene.
+//!
+//! Cells are stored in a hash, so the grid doesn't need to know the size of the scene
+//! and empty cells don't cost any memory.
+//!
+//! Sprites covering too many cells (for example a background) are not split into cells,
+//! but kept in a separate list that is checked by every query.
+//!
+//! The grid is updated incrementally : insert() when a sprite is added, update() when it moves
+//! and remove() when it is removed. update() does nothing if the sprite stays in the same cells.
+//!
+//! The grid only returns candidates : the caller is responsible for testing the exact
+//! intersection between the returned sprites and the queried rect.
+class SpatialGrid {
+
+public:
+    explicit SpatialGrid(qreal cellSize = DEFAULT_CELL_SIZE);
+
+    static constexpr qreal DEFAULT_CELL_SIZE = 128;
+    static constexpr int MAX_CELLS_PER_SPRITE = 64;
+
+    void insert(Sprite* pSprite, const QRectF& rRect);
+    void update(Sprite* pSprite, const QRectF& rRect);
+    void remove(Sprite* pSprite);
+    void clear();
+
+    [[nodiscard]] inline bool contains(const Sprite* pSprite) const { return m_spriteCells.contains(pSprite); }
+    [[nodiscard]] inline int count() const { return static_cast<int>(m_spriteCells.count()); }
+
+    void query(const QRectF& rRect, QList<Sprite*>& rResult) const;
+
+private:
+    //! Range of cells covered by a rect (bounds included).
+    struct CellRange {
+        int left = 0;
+        int top = 0;
+        int right = -1;
+        int bottom = -1;
+
+        [[nodiscard]] inline int cellCount() const { return (right - left + 1) * (bottom - top + 1); }
+        inline bool operator==(const CellRange& rOther) const {
+            return left == rOther.left && top == rOther.top && right == rOther.right && bottom == rOther.bottom;
+        }
+        inline bool operator!=(const CellRange& rOther) const { return !(*this == rOther); }
+    };
+
+    //! A sprite stored in a cell, along with the range of cells it covers.
+    struct CellEntry {
+        Sprite* pSprite;
+        CellRange range;
+    };
+
+    qreal m_cellSize;
+
+    QHash<quint64, QList<CellEntry>> m_cells;
+    QHash<const Sprite*, CellRange> m_spriteCells;
+    QList<Sprite*> m_oversizedSprites;
+
+    [[nodiscard]] CellRange cellRange(const QRectF& rRect) const;
+    [[nodiscard]] static inline quint64 cellKey(int x, int y) {
+        return (static_cast<quint64>(static_cast<quint32>(x)) << 32) | static_cast<quint32>(y);
+    }
+    [[nodiscard]] static inline bool isOversized(const CellRange& rRange) { return rRange.cellCount() > MAX_CELLS_PER_SPRITE; }
+
+    void addToCells(Sprite* pSprite, const CellRange& rRange);
+    void removeFromCells(Sprite* pSprite, const CellRange& rRange);
+};
+
+
+#endif //INC_2023_JCO_AIRTIME_SPATIALGRID_H
@@ -0,0 +1,105 @@
+//
+// Created by blatnoa on 06.06.2023.
+//
+
+#include "StaticCollisionTree.h"
+
+#include <algorithm>
+
+//! Builds the tree from the given sprites.
+//! Replaces the previous content of the tree.
+//! \param items The sprites to bake, along with their scene bounding rects.
+void StaticCollisionTree::build(QList<Item> items) {
+    m_items = std::move(items);
+    m_nodes.clear();
+
+    if (m_items.isEmpty()) { // Nothing to bake
+        return;
+    }
+
+    // A tree with n leaves has 2n - 1 nodes
+    m_nodes.reserve(2 * (m_items.count() / LEAF_SIZE + 1));
+    m_nodes.append(Node());
+    buildNode(0, 0, static_cast<int>(m_items.count()));
+}
+
+//! Removes all sprites from the tree.
+void StaticCollisionTree::clear() {
+    m_items.clear();
+    m_nodes.clear();
+}
+
+//! Appends to the given list the sprites whose bounding rect intersects the given rect.
+//! \param rRect The rect to query.
+//! \param rResult The list to which the found sprites are appended.
+void StaticCollisionTree::query(const QRectF& rRect, QList<Sprite*>& rResult) const {
+    if (m_nodes.isEmpty()) {
+        return;
+    }
+
+    int nodeStack[MAX_DEPTH];
+    int stackSize = 0;
+    nodeStack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        const Node& rNode = m_nodes.at(nodeStack[--stackSize]);
+        if (!rNode.bounds.intersects(rRect)) { // Nothing to find in this node
+            continue;
+        }
+
+        if (rNode.itemCount > 0) { // Leaf
+            for (int i = rNode.firstItem; i < rNode.firstItem + rNode.itemCount; i++) {
+                const Item& rItem = m_items.at(i);
+                if (rItem.rect.intersects(rRect)) {
+                    rResult << rItem.pSprite;
+                }
+            }
+        } else { // Inner node
+            nodeStack[stackSize++] = rNode.leftChild;
+            nodeStack[stackSize++] = rNode.leftChild + 1;
+        }
+    }
+}
+
+//! Builds a node and its children, recursively.
+//! \param nodeIndex The index of the node to build.
+//! \param firstItem The index of the first item contained by the node.
+//! \param itemCount The number of items contained by the node.
+void StaticCollisionTree::buildNode(int nodeIndex, int firstItem, int itemCount) {
+    auto first = m_items.begin() + firstItem;
+    auto last = first + itemCount;
+
+    // Compute the bounds of the node
+    QRectF bounds = first->rect;
+    for (auto it = first + 1; it != last; ++it) {
+        bounds |= it->rect;
+    }
+    m_nodes[nodeIndex].bounds = bounds;
+
+    if (itemCount <= LEAF_SIZE) { // Small enough to be a leaf
+        m_nodes[nodeIndex].firstItem = firstItem;
+        m_nodes[nodeIndex].itemCount = itemCount;
+        return;
+    }
+
+    // Split the items at the median of the longest axis
+    int half = itemCount / 2;
+    if (bounds.width() >= bounds.height()) {
+        std::nth_element(first, first + half, last, [](const Item& rA, const Item& rB) {
+            return rA.rect.center().x() < rB.rect.center().x();
+        });
+    } else {
+        std::nth_element(first, first + half, last, [](const Item& rA, const Item& rB) {
+            return rA.rect.center().y() < rB.rect.center().y();
+        });
+    }
+
+    // Children are allocated side by side
+    int leftChild = static_cast<int>(m_nodes.count());
+    m_nodes.append(Node());
+    m_nodes.append(Node());
+    m_nodes[nodeIndex].leftChild = leftChild;
+
+    buildNode(leftChild, firstItem, half);
+    buildNode(leftChild + 1, firstItem + half, itemCount - half);
+}
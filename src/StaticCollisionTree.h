@@ -0,0 +1,70 @@
+/**
+\file     StaticCollisionTree.h
+\brief    Déclaration de la classe StaticCollisionTree.
+\author   Blattner Noah
+\date     juin 2023
+*/
+
+#ifndef INC_2023_JCO_AIRTIME_STATICCOLLISIONTREE_H
+#define INC_2023_JCO_AIRTIME_STATICCOLLISIONTREE_H
+
+#include <QList>
+#include <QRectF>
+
+class Sprite;
+
+//! \brief An immutable bounding volume hierarchy (BVH) of the sprites that never move.
+//!
+//! Most of the sprites of a level (walls, platforms, ledges, decorations) never move.
+//! Keeping them in a structure that is updated incrementally would cost time for nothing,
+//! so they are baked once into this tree, after the level is loaded.
+//!
+//! The tree is built top-down : the sprites are sorted along the longest axis of the node
+//! and split at the median, until a node contains at most LEAF_SIZE sprites.
+//! Nodes are stored in a flat list, children of a node being found by index.
+//!
+//! The tree can't be modified once built. Adding or removing a static sprite requires
+//! the tree to be built again with build().
+//!
+//! Unlike SpatialGrid, query() returns exact results : the scene bounding rect of every
+//! returned sprite intersects the queried rect.
+class StaticCollisionTree {
+
+public:
+    //! A sprite to bake into the tree, along with its scene bounding rect.
+    struct Item {
+        Sprite* pSprite;
+        QRectF rect;
+    };
+
+    static constexpr int LEAF_SIZE = 4;
+
+    void build(QList<Item> items);
+    void clear();
+
+    [[nodiscard]] inline bool isEmpty() const { return m_items.isEmpty(); }
+    [[nodiscard]] inline int count() const { return static_cast<int>(m_items.count()); }
+
+    void query(const QRectF& rRect, QList<Sprite*>& rResult) const;
+
+private:
+    //! A node of the tree.
+    //! Leaves reference a range of items, inner nodes reference their two children.
+    struct Node {
+        QRectF bounds;
+        int firstItem = 0;  // Leaf only : index of the first item of the leaf
+        int itemCount = 0;  // Leaf only : number of items of the leaf (0 for an inner node)
+        int leftChild = -1; // Inner node only. The right child is always leftChild + 1.
+    };
+
+    // Large enough for any tree built by median splits
+    static constexpr int MAX_DEPTH = 64;
+
+    QList<Item> m_items;
+    QList<Node> m_nodes;
+
+    void buildNode(int nodeIndex, int firstItem, int itemCount);
+};
+
+
+#endif //INC_2023_JCO_AIRTIME_STATICCOLLISIONTREE_H
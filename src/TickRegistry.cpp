@@ -0,0 +1,100 @@
+//
+// Created by blatnoa on 09.06.2023.
+//
+
+#include "TickRegistry.h"
+
+#include <utility>
+
+//! Constructor :
+//! Creates an empty registry.
+TickRegistry::TickRegistry() {
+    m_removedDuringDispatch = 0;
+    m_isDispatching = false;
+}
+
+//! Registers a sprite.
+//! During a dispatch, the sprite is only added when the dispatch ends.
+//! Adding a sprite that is already registered has no effect.
+//! \param pSprite The sprite to register.
+void TickRegistry::add(Sprite* pSprite) {
+    if (contains(pSprite)) {
+        return;
+    }
+
+    if (m_isDispatching) {
+        m_pendingAdditions << pSprite;
+        return;
+    }
+
+    m_indexes.insert(pSprite, static_cast<int>(m_sprites.count()));
+    m_sprites << pSprite;
+}
+
+//! Unregisters a sprite.
+//! During a dispatch, the sprite is replaced by a null pointer until the dispatch ends.
+//! \param pSprite The sprite to unregister.
+void TickRegistry::remove(Sprite* pSprite) {
+    auto it = m_indexes.find(pSprite);
+    if (it == m_indexes.end()) { // The sprite may be waiting to be added
+        if (m_isDispatching) {
+            m_pendingAdditions.removeOne(pSprite);
+        }
+        return;
+    }
+
+    int index = it.value();
+    m_indexes.erase(it);
+
+    if (m_isDispatching) {
+        m_sprites[index] = nullptr;
+        m_removedDuringDispatch++;
+    } else {
+        removeAt(index);
+    }
+}
+
+//! Checks if a sprite is registered, or will be once the current dispatch ends.
+//! \param pSprite The sprite.
+//! \return True if the sprite is registered.
+bool TickRegistry::contains(const Sprite* pSprite) const {
+    return m_indexes.contains(pSprite) || (m_isDispatching && m_pendingAdditions.contains(pSprite));
+}
+
+//! Starts dispatching the registered sprites.
+//! Until endDispatch(), sprites() keeps its size and order.
+void TickRegistry::beginDispatch() {
+    m_isDispatching = true;
+}
+
+//! Ends the dispatch : fills the holes left by the removed sprites and appends the added sprites.
+void TickRegistry::endDispatch() {
+    m_isDispatching = false;
+
+    // Fill the holes from the end of the list
+    for (int i = static_cast<int>(m_sprites.count()) - 1; i >= 0 && m_removedDuringDispatch > 0; i--) {
+        if (m_sprites.at(i) == nullptr) {
+            removeAt(i);
+            m_removedDuringDispatch--;
+        }
+    }
+
+    for (Sprite* pSprite : std::as_const(m_pendingAdditions)) {
+        m_indexes.insert(pSprite, static_cast<int>(m_sprites.count()));
+        m_sprites << pSprite;
+    }
+    m_pendingAdditions.clear();
+}
+
+//! Removes the entry at the given index, by moving the last entry into its place.
+//! \param index The index of the entry.
+void TickRegistry::removeAt(int index) {
+    Sprite* pLastSprite = m_sprites.last();
+    m_sprites.removeLast();
+    if (index < m_sprites.count()) {
+        m_sprites[index] = pLastSprite;
+        if (pLastSprite != nullptr) {
+            m_indexes[pLastSprite] = index;
+        }
+    }
+}
@@ -0,0 +1,68 @@
+/**
+\file     TickRegistry.h
+\brief    Déclaration de la classe TickRegistry.
+\author   Blattner Noah
+\date     juin 2023
+*/
+
+#ifndef INC_2023_JCO_AIRTIME_TICKREGISTRY_H
+#define INC_2023_JCO_AIRTIME_TICKREGISTRY_H
+
+#include <QHash>
+#include <QList>
+
+class Sprite;
+
+//! The phases of a tick, dispatched in this order by GameScene::tick().
+//! A sprite registers for the phases in which it has work to do.
+enum TickPhase {
+    InputPhase,         // Applies the inputs (player controls)
+    PrePhysicsPhase,    // Moves the sprites that carry others (moving platforms)
+    PhysicsPhase,       // Moves the physics entities
+    PostPhysicsPhase,   // Reacts to the final positions of the entities (particles chasing a target)
+    AnimationPhase,     // Updates the appearance of the sprites
+    CameraPhase,        // Moves the view
+    TickPhaseCount
+};
+
+//! \brief The list of the sprites registered for a phase of the tick of a scene.
+//!
+//! The sprites are stored in a flat list, with the index of each sprite in a hash,
+//! so that adding, removing and finding a sprite take constant time.
+//! A sprite is removed by moving the last sprite of the list into its place (swap-and-pop) :
+//! the order of the sprites is therefore not preserved.
+//!
+//! Sprites can register and unregister while the list is being dispatched (between
+//! beginDispatch() and endDispatch()), without the list having to be copied :
+//! - A removed sprite is replaced by a null pointer, so that it isn't ticked anymore and
+//!   the other sprites keep their index. The holes are filled by endDispatch().
+//! - An added sprite is queued and only appended by endDispatch(). It is ticked from the next dispatch on.
+class TickRegistry {
+
+public:
+    TickRegistry();
+
+    void add(Sprite* pSprite);
+    void remove(Sprite* pSprite);
+    [[nodiscard]] bool contains(const Sprite* pSprite) const;
+
+    void beginDispatch();
+    void endDispatch();
+
+    //! The registered sprites. During a dispatch, the list keeps its size but may contain null pointers.
+    [[nodiscard]] inline const QList<Sprite*>& sprites() const { return m_sprites; }
+    [[nodiscard]] inline int count() const { return static_cast<int>(m_indexes.count()); }
+    [[nodiscard]] inline bool isDispatching() const { return m_isDispatching; }
+
+private:
+    void removeAt(int index);
+
+    QList<Sprite*> m_sprites;
+    QHash<const Sprite*, int> m_indexes;    // Index of each sprite in m_sprites
+    QList<Sprite*> m_pendingAdditions;      // Sprites added during the dispatch
+    int m_removedDuringDispatch;            // Number of holes left in m_sprites by the dispatch
+    bool m_isDispatching;
+};
+
+
+#endif //INC_2023_JCO_AIRTIME_TICKREGISTRY_H
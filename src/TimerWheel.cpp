@@ -0,0 +1,239 @@
+//
+// Created by blatnoa on 09.06.2023.
+//
+
+#include "TimerWheel.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+//! Constructor :
+//! Creates an empty wheel at time 0.
+TimerWheel::TimerWheel() {
+    std::fill(std::begin(m_slotHeads), std::end(m_slotHeads), NO_NODE);
+    m_firstFreeNode = NO_NODE;
+    m_timerCount = 0;
+    m_currentTime = 0;
+}
+
+//! Schedules a callback to run after the given delay of game time.
+//! The callback runs during advance(), once the delay has elapsed.
+//! \param delayInMilliseconds The delay before the callback runs. Delays under 1 millisecond are rounded up.
+//! \param callback The callback to run.
+//! \param pOwner The owner of the timer, used by cancelAll(). Can be null.
+//! \return The id of the timer, used to cancel it.
+TimerWheel::TimerId TimerWheel::schedule(long long delayInMilliseconds, Callback callback, const void* pOwner) {
+    // Reuse a free node of the pool if there is one
+    int index = m_firstFreeNode;
+    if (index == NO_NODE) {
+        index = static_cast<int>(m_nodes.count());
+        m_nodes.append(Node{0, nullptr, nullptr, 0, NO_NODE, NO_NODE, NO_NODE});
+    } else {
+        m_firstFreeNode = m_nodes[index].next;
+    }
+
+    Node& rNode = m_nodes[index];
+    rNode.expiry = m_currentTime + qMax(delayInMilliseconds, 1LL);
+    rNode.callback = std::move(callback);
+    rNode.pOwner = pOwner;
+    insert(index);
+
+    m_timerCount++;
+    if (pOwner != nullptr) {
+        m_ownerTimerCounts[pOwner]++;
+    }
+
+    return (static_cast<TimerId>(rNode.generation) << 32) | static_cast<TimerId>(index + 1);
+}
+
+//! Cancels a scheduled timer. Its callback will not run.
+//! \param timerId The id of the timer.
+//! \return True if the timer was scheduled, false if it had already fired or been cancelled.
+bool TimerWheel::cancel(TimerId timerId) {
+    int index = nodeIndex(timerId);
+    if (index == NO_NODE) {
+        return false;
+    }
+
+    unlink(index);
+    release(index);
+    return true;
+}
+
+//! Cancels every scheduled timer of the given owner.
+//! \param pOwner The owner of the timers.
+void TimerWheel::cancelAll(const void* pOwner) {
+    auto it = m_ownerTimerCounts.find(pOwner);
+    if (it == m_ownerTimerCounts.end()) { // The owner never scheduled a timer
+        return;
+    }
+
+    if (it.value() > 0) {
+        for (int i = 0; i < m_nodes.count(); i++) {
+            if (m_nodes[i].slot != NO_NODE && m_nodes[i].pOwner == pOwner) {
+                unlink(i);
+                release(i);
+            }
+        }
+    }
+    m_ownerTimerCounts.remove(pOwner);
+}
+
+//! Checks if a timer is still waiting to fire.
+//! \param timerId The id of the timer.
+//! \return True if the timer is scheduled.
+bool TimerWheel::isScheduled(TimerId timerId) const {
+    return nodeIndex(timerId) != NO_NODE;
+}
+
+//! Moves the wheel forward and runs the callbacks of the timers that expire.
+//! Callbacks can schedule and cancel timers. A timer scheduled by a callback never runs during the same millisecond.
+//! \param elapsedTimeInMilliseconds The elapsed game time.
+void TimerWheel::advance(long long elapsedTimeInMilliseconds) {
+    long long targetTime = m_currentTime + elapsedTimeInMilliseconds;
+
+    while (m_currentTime < targetTime) {
+        if (m_timerCount == 0) { // Nothing can expire
+            m_currentTime = targetTime;
+            return;
+        }
+
+        m_currentTime++;
+
+        // When a level completes a revolution, the next slot of the levels above is cascaded down
+        for (int level = LEVEL_COUNT - 1; level > 0; level--) {
+            if ((m_currentTime & ((1LL << (SLOT_BITS * level)) - 1)) == 0) {
+                cascade(level);
+            }
+        }
+
+        fireExpired();
+    }
+}
+
+//! Drops every timer without running its callback.
+void TimerWheel::clear() {
+    // The nodes are kept in the pool, so that the ids of the dropped timers stay invalid
+    for (int i = 0; i < m_nodes.count(); i++) {
+        if (m_nodes[i].slot != NO_NODE) {
+            unlink(i);
+            release(i);
+        }
+    }
+    m_ownerTimerCounts.clear();
+}
+
+//! Links a node in the slot matching its expiry.
+//! The closer the expiry, the lower the level.
+//! \param nodeIndex The index of the node.
+void TimerWheel::insert(int nodeIndex) {
+    Node& rNode = m_nodes[nodeIndex];
+
+    long long delay = qMax(rNode.expiry - m_currentTime, 0LL);
+    long long slotTime = rNode.expiry;
+
+    int level = 0;
+    while (level < LEVEL_COUNT - 1 && delay >= (1LL << (SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+    if (delay >= (1LL << (SLOT_BITS * LEVEL_COUNT))) {
+        // Beyond the wheel : parked in the farthest slot, then cascaded again until it is close enough
+        slotTime = m_currentTime + (1LL << (SLOT_BITS * LEVEL_COUNT)) - 1;
+    }
+
+    rNode.slot = level * SLOT_COUNT + static_cast<int>((slotTime >> (SLOT_BITS * level)) & SLOT_MASK);
+    rNode.previous = NO_NODE;
+    rNode.next = m_slotHeads[rNode.slot];
+    if (rNode.next != NO_NODE) {
+        m_nodes[rNode.next].previous = nodeIndex;
+    }
+    m_slotHeads[rNode.slot] = nodeIndex;
+}
+
+//! Removes a node from the list of its slot.
+//! \param nodeIndex The index of the node.
+void TimerWheel::unlink(int nodeIndex) {
+    const Node& rNode = m_nodes.at(nodeIndex);
+
+    if (rNode.previous == NO_NODE) {
+        m_slotHeads[rNode.slot] = rNode.next;
+    } else {
+        m_nodes[rNode.previous].next = rNode.next;
+    }
+    if (rNode.next != NO_NODE) {
+        m_nodes[rNode.next].previous = rNode.previous;
+    }
+}
+
+//! Returns an unlinked node to the pool.
+//! The generation of the node changes, so that the id of the timer becomes invalid.
+//! \param nodeIndex The index of the node.
+void TimerWheel::release(int nodeIndex) {
+    Node& rNode = m_nodes[nodeIndex];
+
+    if (rNode.pOwner != nullptr) {
+        auto it = m_ownerTimerCounts.find(rNode.pOwner);
+        if (it != m_ownerTimerCounts.end()) {
+            it.value()--;
+        }
+    }
+
+    rNode.callback = nullptr;
+    rNode.pOwner = nullptr;
+    rNode.generation++;
+    rNode.slot = NO_NODE;
+    rNode.previous = NO_NODE;
+    rNode.next = m_firstFreeNode;
+    m_firstFreeNode = nodeIndex;
+
+    m_timerCount--;
+}
+
+//! Moves the timers of the current slot of the given level to the lower levels.
+//! \param level The level to cascade.
+void TimerWheel::cascade(int level) {
+    int slot = level * SLOT_COUNT + static_cast<int>((m_currentTime >> (SLOT_BITS * level)) & SLOT_MASK);
+
+    int index = m_slotHeads[slot];
+    m_slotHeads[slot] = NO_NODE;
+    while (index != NO_NODE) {
+        int next = m_nodes.at(index).next;
+        insert(index);
+        index = next;
+    }
+}
+
+//! Runs the callbacks of the timers expiring at the current time.
+void TimerWheel::fireExpired() {
+    int slot = static_cast<int>(m_currentTime & SLOT_MASK);
+
+    // Timers are taken one at a time : a callback may cancel the other timers of the slot
+    while (m_slotHeads[slot] != NO_NODE) {
+        int index = m_slotHeads[slot];
+        Callback callback = std::move(m_nodes[index].callback);
+
+        unlink(index);
+        release(index);
+
+        if (callback) {
+            callback();
+        }
+    }
+}
+
+//! Finds the node of a scheduled timer.
+//! \param timerId The id of the timer.
+//! \return The index of the node, or NO_NODE if the timer isn't scheduled anymore.
+int TimerWheel::nodeIndex(TimerId timerId) const {
+    int index = static_cast<int>(timerId & 0xFFFFFFFF) - 1;
+    if (index < 0 || index >= m_nodes.count()) {
+        return NO_NODE;
+    }
+
+    const Node& rNode = m_nodes.at(index);
+    if (rNode.slot == NO_NODE || rNode.generation != static_cast<quint32>(timerId >> 32)) {
+        return NO_NODE;
+    }
+    return index;
+}
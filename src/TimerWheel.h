@@ -0,0 +1,87 @@
+/**
+\file     TimerWheel.h
+\brief    Déclaration de la classe TimerWheel.
+\author   Blattner Noah
+\date     juin 2023
+*/
+
+#ifndef INC_2023_JCO_AIRTIME_TIMERWHEEL_H
+#define INC_2023_JCO_AIRTIME_TIMERWHEEL_H
+
+#include <functional>
+#include <QHash>
+#include <QList>
+
+//! \brief A hierarchical timer wheel that runs delayed callbacks on game time.
+//!
+//! The wheel doesn't have its own clock : it only moves forward when advance() is called,
+//! usually once per tick by the GameScene that owns it. Delays are therefore counted in game
+//! time : they stop while the game is paused and always fire on the same tick for the same inputs.
+//!
+//! Timers are sorted into LEVEL_COUNT levels of SLOT_COUNT slots.
+//! A slot of the first level covers one millisecond, a slot of each next level covers a whole
+//! revolution of the previous level. When a level completes a revolution, the next slot of the
+//! level above is cascaded down, so that each timer is only moved a few times before it fires.
+//!
+//! Scheduling and cancelling a timer take constant time. The timers live in a pool that is
+//! reused, so scheduling doesn't allocate once the pool is large enough.
+//!
+//! Each timer can be given an owner. cancelAll() cancels every timer of an owner, for example
+//! when a sprite leaves the scene, so that no callback runs on a destroyed object.
+class TimerWheel {
+
+public:
+    using Callback = std::function<void()>;
+
+    //! Identifies a scheduled timer. INVALID_TIMER is never returned by schedule().
+    using TimerId = quint64;
+    static constexpr TimerId INVALID_TIMER = 0;
+
+    TimerWheel();
+
+    TimerId schedule(long long delayInMilliseconds, Callback callback, const void* pOwner = nullptr);
+    bool cancel(TimerId timerId);
+    void cancelAll(const void* pOwner);
+    [[nodiscard]] bool isScheduled(TimerId timerId) const;
+
+    void advance(long long elapsedTimeInMilliseconds);
+    void clear();
+
+    [[nodiscard]] inline int timerCount() const { return m_timerCount; }
+    [[nodiscard]] inline long long currentTime() const { return m_currentTime; }
+
+private:
+    static constexpr int SLOT_BITS = 6;
+    static constexpr int SLOT_COUNT = 1 << SLOT_BITS;
+    static constexpr int SLOT_MASK = SLOT_COUNT - 1;
+    static constexpr int LEVEL_COUNT = 4;
+    static constexpr int NO_NODE = -1;
+
+    //! A timer of the pool, linked in the list of its slot.
+    struct Node {
+        long long expiry;       // Game time at which the timer fires
+        Callback callback;
+        const void* pOwner;
+        quint32 generation;     // Incremented each time the node is reused, to invalidate old ids
+        int slot;               // Index of the slot containing the timer, NO_NODE if the node is free
+        int previous;
+        int next;               // Next node of the slot, or next free node
+    };
+
+    void insert(int nodeIndex);
+    void unlink(int nodeIndex);
+    void release(int nodeIndex);
+    void cascade(int level);
+    void fireExpired();
+    [[nodiscard]] int nodeIndex(TimerId timerId) const;
+
+    QList<Node> m_nodes;
+    int m_slotHeads[LEVEL_COUNT * SLOT_COUNT];
+    int m_firstFreeNode;
+    int m_timerCount;
+    long long m_currentTime;
+    QHash<const void*, int> m_ownerTimerCounts; // Number of scheduled timers of each owner
+};
+
+
+#endif //INC_2023_JCO_AIRTIME_TIMERWHEEL_H
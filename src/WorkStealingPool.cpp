@@ -0,0 +1,181 @@
+//
+// Created by blatnoa on 10.06.2023.
+//
+
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+
+//! Constructor :
+//! Starts the worker threads. They sleep until a loop is run.
+//! \param workerCount The number of worker threads. With 0 workers, the loops run on the calling thread only.
+WorkStealingPool::WorkStealingPool(int workerCount) {
+    workerCount = std::max(workerCount, 0);
+
+    m_queueCount = workerCount + 1;
+    m_queues = std::make_unique<Queue[]>(m_queueCount);
+
+    m_workers.reserve(workerCount);
+    for (int i = 0; i < workerCount; i++) {
+        m_workers.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+//! Destructor :
+//! Stops the worker threads and waits for them to end.
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        m_isStopping = true;
+    }
+    m_wakeCondition.notify_all();
+
+    for (std::thread& rWorker : m_workers) {
+        rWorker.join();
+    }
+}
+
+//! Returns the pool shared by the whole game.
+//! It has one worker less than the number of cores, as the calling thread takes part in the loops.
+//! \return The shared pool.
+WorkStealingPool& WorkStealingPool::instance() {
+    static WorkStealingPool pool(static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    return pool;
+}
+
+//! Runs the job for each index from 0 to count (excluded), in parallel.
+//! Returns once the job has run for every index.
+//! Small loops, or loops on a pool without workers, run directly on the calling thread.
+//! \param count The number of indexes.
+//! \param job The job to run for each index.
+//! \param grainSize The number of indexes under which a range isn't split anymore.
+void WorkStealingPool::parallelFor(int count, const Job& job, int grainSize) {
+    if (count <= 0) {
+        return;
+    }
+
+    grainSize = std::max(grainSize, 1);
+    if (m_workers.empty() || count <= grainSize) { // Not worth waking the workers up
+        for (int i = 0; i < count; i++) {
+            job(i);
+        }
+        return;
+    }
+
+    m_pJob = &job;
+    m_grainSize = grainSize;
+    m_remainingCount.store(count);
+
+    // Each thread starts with an equal share of the indexes
+    for (int queueIndex = 0; queueIndex < m_queueCount; queueIndex++) {
+        int begin = static_cast<int>(static_cast<long long>(count) * queueIndex / m_queueCount);
+        int end = static_cast<int>(static_cast<long long>(count) * (queueIndex + 1) / m_queueCount);
+        if (begin < end) {
+            pushRange(queueIndex, Range{begin, end});
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        m_loopGeneration++;
+    }
+    m_wakeCondition.notify_all();
+
+    // The calling thread works too, then waits for the ranges still running on the workers
+    runRanges(m_queueCount - 1);
+
+    std::unique_lock<std::mutex> lock(m_stateMutex);
+    m_doneCondition.wait(lock, [this]() { return m_remainingCount.load() == 0; });
+    m_pJob = nullptr;
+}
+
+//! Loop of a worker thread : waits for a loop to start, then takes part in it.
+//! \param queueIndex The index of the queue of the worker.
+void WorkStealingPool::workerLoop(int queueIndex) {
+    unsigned long long seenGeneration = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_stateMutex);
+            m_wakeCondition.wait(lock, [this, seenGeneration]() {
+                return m_isStopping || m_loopGeneration != seenGeneration;
+            });
+            if (m_isStopping) {
+                return;
+            }
+            seenGeneration = m_loopGeneration;
+        }
+
+        runRanges(queueIndex);
+    }
+}
+
+//! Runs ranges of the current loop, from the own queue first, then stolen from the others.
+//! Returns when no range is left in any queue : the remaining ranges are already running.
+//! \param queueIndex The index of the queue of the running thread.
+void WorkStealingPool::runRanges(int queueIndex) {
+    Range range{0, 0};
+
+    while (takeRange(queueIndex, range) || stealRange(queueIndex, range)) {
+        // Split the range until it is small enough, so that the other halves can be stolen
+        while (range.end - range.begin > m_grainSize) {
+            int middle = range.begin + (range.end - range.begin) / 2;
+            pushRange(queueIndex, Range{middle, range.end});
+            range.end = middle;
+        }
+
+        for (int i = range.begin; i < range.end; i++) {
+            (*m_pJob)(i);
+        }
+
+        int rangeCount = range.end - range.begin;
+        if (m_remainingCount.fetch_sub(rangeCount) == rangeCount) { // Last range of the loop
+            std::lock_guard<std::mutex> lock(m_stateMutex);
+            m_doneCondition.notify_one();
+        }
+    }
+}
+
+//! Takes the most recent range of a queue.
+//! \param queueIndex The index of the queue.
+//! \param rRange The taken range.
+//! \return True if a range was taken.
+bool WorkStealingPool::takeRange(int queueIndex, Range& rRange) {
+    Queue& rQueue = m_queues[queueIndex];
+    std::lock_guard<std::mutex> lock(rQueue.mutex);
+
+    if (rQueue.ranges.empty()) {
+        return false;
+    }
+
+    rRange = rQueue.ranges.back();
+    rQueue.ranges.pop_back();
+    return true;
+}
+
+//! Steals the oldest range of the first other queue that isn't empty.
+//! \param queueIndex The index of the queue of the thief.
+//! \param rRange The stolen range.
+//! \return True if a range was stolen.
+bool WorkStealingPool::stealRange(int queueIndex, Range& rRange) {
+    for (int offset = 1; offset < m_queueCount; offset++) {
+        Queue& rVictim = m_queues[(queueIndex + offset) % m_queueCount];
+        std::lock_guard<std::mutex> lock(rVictim.mutex);
+
+        if (!rVictim.ranges.empty()) {
+            rRange = rVictim.ranges.front();
+            rVictim.ranges.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+//! Pushes a range at the back of a queue.
+//! \param queueIndex The index of the queue.
+//! \param range The range to push.
+void WorkStealingPool::pushRange(int queueIndex, Range range) {
+    Queue& rQueue = m_queues[queueIndex];
+    std::lock_guard<std::mutex> lock(rQueue.mutex);
+    rQueue.ranges.push_back(range);
+}
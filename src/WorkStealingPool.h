@@ -0,0 +1,88 @@
+/**
+\file     WorkStealingPool.h
+\brief    Déclaration de la classe WorkStealingPool.
+\author   Blattner Noah
+\date     juin 2023
+*/
+
+#ifndef INC_2023_JCO_AIRTIME_WORKSTEALINGPOOL_H
+#define INC_2023_JCO_AIRTIME_WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! \brief A pool of worker threads that runs a loop in parallel, balanced by work stealing.
+//!
+//! parallelFor() splits a range of indexes between the queues of the workers and of the calling
+//! thread, which also takes part in the work. Each thread takes the most recent range of its own
+//! queue and splits it in halves until it is small enough to be run, pushing the other half back.
+//! A thread whose queue is empty steals the oldest (and largest) range from the queue of another
+//! thread, so that the threads stay busy even when some indexes take longer than others.
+//!
+//! The job must not touch anything shared with the other indexes : it is typically used to
+//! update independent chunks of data (for example the particles of a ParticleEmitter),
+//! whose results are applied afterwards on a single thread.
+//!
+//! parallelFor() must only be called from one thread at a time (the thread of the game loop),
+//! and not from inside a job. The pool is shared by the whole game, see instance().
+class WorkStealingPool {
+
+public:
+    using Job = std::function<void(int index)>;
+
+    explicit WorkStealingPool(int workerCount);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    static WorkStealingPool& instance();
+
+    void parallelFor(int count, const Job& job, int grainSize = DEFAULT_GRAIN_SIZE);
+
+    [[nodiscard]] inline int workerCount() const { return static_cast<int>(m_workers.size()); }
+
+private:
+    static constexpr int DEFAULT_GRAIN_SIZE = 16; // Number of indexes under which a range isn't split anymore
+
+    //! A range of indexes, from begin (included) to end (excluded).
+    struct Range {
+        int begin;
+        int end;
+    };
+
+    //! The queue of ranges of a thread. The owner takes from the back, thieves from the front.
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Range> ranges;
+    };
+
+    void workerLoop(int queueIndex);
+    void runRanges(int queueIndex);
+    bool takeRange(int queueIndex, Range& rRange);
+    bool stealRange(int queueIndex, Range& rRange);
+    void pushRange(int queueIndex, Range range);
+
+    std::vector<std::thread> m_workers;
+    std::unique_ptr<Queue[]> m_queues;  // One queue per worker, the last one belongs to the calling thread
+    int m_queueCount;
+
+    const Job* m_pJob = nullptr;
+    int m_grainSize = DEFAULT_GRAIN_SIZE;
+    std::atomic<int> m_remainingCount{0};   // Indexes of the current loop that haven't been run yet
+
+    std::mutex m_stateMutex;
+    std::condition_variable m_wakeCondition;    // Wakes the workers when a loop starts
+    std::condition_variable m_doneCondition;    // Wakes the calling thread when the loop is over
+    unsigned long long m_loopGeneration = 0;
+    bool m_isStopping = false;
+};
+
+
+#endif //INC_2023_JCO_AIRTIME_WORKSTEALINGPOOL_H
@@ -19,6 +19,7 @@
 #include <QKeyEvent>
 
 const int DEFAULT_TICK_INTERVAL = 20;
+const int NANOSECONDS_PER_MILLISECOND = 1000000;
 
 #ifdef QT_DEBUG
 const int STAT_TRIGGER_INTERVAL = 1000;
@@ -26,10 +27,11 @@ const int STAT_TRIGGER_INTERVAL = 1000;
 
 //!
 //! Construit le canvas de jeu, qui se charge de faire l'interface entre GameView, GameScene et GameCore.
-//! \param pView    La vue qui affiche les scènes du jeu.
+//! \param pView    La vue qui affiche les scènes du jeu. Si nullptr, le jeu fonctionne sans affichage (voir isHeadless()).
 //! \param pParent  Objet parent.
 GameCanvas::GameCanvas(GameView* pView, QObject* pParent) : QObject(pParent) {
     m_pView = pView;
+    m_pCurrentScene = nullptr;
     m_pGameCore = nullptr;
     m_pDetailedInfosItem = nullptr;
 
@@ -37,12 +39,19 @@ GameCanvas::GameCanvas(GameView* pView, QObject* pParent) : QObject(pParent) {
 
     m_tickInterval = DEFAULT_TICK_INTERVAL;
 
+    m_isFixedTimeStep = false;
+    m_fixedStepDuration = DEFAULT_TICK_INTERVAL;
+    m_maxSubsteps = DEFAULT_MAX_SUBSTEPS;
+    m_accumulatedTimeNs = 0;
+
     m_tickTimer.setSingleShot(false);
     m_tickTimer.setInterval(m_tickInterval);
     m_tickTimer.setTimerType(Qt::PreciseTimer); // Important pour avoir un précision suffisante sous Windows
     connect(&m_tickTimer, &QTimer::timeout, this, &GameCanvas::onTick);
 
-    initDetailedInfos();
+    // Sans affichage, il n'y a pas de HUD où placer les informations détaillées
+    if (!isHeadless())
+        initDetailedInfos();
 
     // Il faut installer un filtre au niveau de GameView, afin de maîtriser complètement l'effet
     // des touches du clavier.
@@ -53,6 +62,12 @@ GameCanvas::GameCanvas(GameView* pView, QObject* pParent) : QObject(pParent) {
     // dans GameView, c'est trop tôt : Pour ces événements, QGraphicsView les transforme dans le système
     // de coordonnées de la scène avant de les transmettre à la scène. C'est une fois transformés
     // qu'il faut les filtrer.
+    if (isHeadless()) {
+        // Sans affichage, aucun signal ne doit être connecté : GameCore est disponible dès la construction.
+        onInit();
+        return;
+    }
+
     m_pView->installEventFilter(this);
 
     QTimer::singleShot(0, this, SLOT(onInit()));
@@ -118,18 +133,25 @@ GameScene* GameCanvas::createScene(qreal x, qreal y, qreal width, qreal height)
 }
 
 //! Change la scène de jeu actuellement affichée.
+//! Sans affichage, la scène devient simplement la scène qui reçoit le tick.
 void GameCanvas::setCurrentScene(GameScene* pScene) {
-    m_pView->setScene(pScene);
+    m_pCurrentScene = pScene;
+    if (m_pView)
+        m_pView->setScene(pScene);
 }
 
 //! \return un pointeur sur la scène qui est actuellement affichée par GameView.
 GameScene* GameCanvas::currentScene() const {
-    return static_cast<GameScene*>(m_pView->scene());
+    return m_pCurrentScene;
 }
 
 //! Détermine la scène qui sera affichée comme HUD.
+//! Sans affichage, il n'y a pas de HUD et cette méthode ne fait rien.
 //! \param pHudScene Scène à afficher comme HUD.
 void GameCanvas::setHudScene(QGraphicsScene* pHudScene) {
+    if (!m_pView)
+        return;
+
     if (hudScene())
         hudScene()->removeItem(m_pDetailedInfosItem);
 
@@ -137,9 +159,9 @@ void GameCanvas::setHudScene(QGraphicsScene* pHudScene) {
     pHudScene->addItem(m_pDetailedInfosItem);
 }
 
-//! \return la scène utilisée comme HUD.
+//! \return la scène utilisée comme HUD, ou nullptr sans affichage.
 QGraphicsScene* GameCanvas::hudScene() const {
-    return m_pView->hudScene();
+    return m_pView ? m_pView->hudScene() : nullptr;
 }
 
 //!
@@ -158,8 +180,12 @@ void GameCanvas::startTick(int tickInterval)  {
     resetStatistics();
 #endif
     m_keepTicking = true;
+    m_accumulatedTimeNs = 0;
     m_lastUpdateTime.start();
-    m_tickTimer.start();
+
+    // Sans affichage, le jeu est piloté par step()
+    if (!isHeadless())
+        m_tickTimer.start();
 }
 
 //!
@@ -177,21 +203,53 @@ bool GameCanvas::isTicking() const {
     return m_keepTicking;
 }
 
+//! Simule le jeu avec des ticks de durée fixe, indépendamment de l'intervalle du timer.
+//! La durée d'un tick étant exprimée en millisecondes, elle est arrondie à la milliseconde.
+//! \param stepRate     Nombre de ticks par seconde.
+//! \param maxSubsteps  Nombre maximal de ticks exécutés à chaque déclenchement du timer. Si le
+//! jeu prend davantage de retard, le temps restant est abandonné : le jeu ralentit au lieu
+//! d'accumuler toujours plus de retard.
+void GameCanvas::setFixedTimeStep(int stepRate, int maxSubsteps) {
+    Q_ASSERT(stepRate > 0);
+    Q_ASSERT(maxSubsteps > 0);
+
+    m_isFixedTimeStep = true;
+    m_fixedStepDuration = qMax(1, qRound(1000.0 / stepRate));
+    m_maxSubsteps = maxSubsteps;
+    m_accumulatedTimeNs = 0;
+}
+
+//! Simule le jeu avec des ticks dont la durée est le temps réellement écoulé (mode par défaut).
+void GameCanvas::setVariableTimeStep() {
+    m_isFixedTimeStep = false;
+    m_accumulatedTimeNs = 0;
+
+    // Les sprites sont à nouveau affichés à leur position réelle
+    if (currentScene())
+        currentScene()->interpolate(1.0);
+}
+
 //! Enclenche le suivi du déplacement de la souris.
 void GameCanvas::startMouseTracking() {
-    m_pView->setMouseTracking(true);
+    if (m_pView)
+        m_pView->setMouseTracking(true);
 }
 
 //! Déclenche le suivi du déplacement de la souris.
 void GameCanvas::stopMouseTracking() {
-    m_pView->setMouseTracking(false);
+    if (m_pView)
+        m_pView->setMouseTracking(false);
 }
 
 //!
 //! \return la position actuelle de la souris, dans le système de coordonnées de la scène actuelle.
+//! Sans affichage, retourne l'origine de la scène.
 //!
 QPointF GameCanvas::currentMousePosition() const
 {
+    if (!m_pView)
+        return QPointF();
+
     return m_pView->mapToScene(m_pView->mapFromGlobal(QCursor::pos()));
 }
 
@@ -306,17 +364,21 @@ void GameCanvas::mouseButtonReleased(QGraphicsSceneMouseEvent* pMouseEvent) {
 //! ne sont pas encore connectés.
 void GameCanvas::onInit() {
     // Mise en place d'un HUD par défaut
-    QGraphicsScene* pHud = new QGraphicsScene(0,0, m_pView->width(), 50);
-    setHudScene(pHud);
+    if (m_pView) {
+        QGraphicsScene* pHud = new QGraphicsScene(0,0, m_pView->width(), 50);
+        setHudScene(pHud);
+    }
 
     m_pGameCore = new GameCore(this, this);
 }
 
 //! Traite le tick : le temps exact écoulé entre ce tick et le tick précédent
 //! est mesuré et l'objet GameCore est lui-même informé du tick.
+//! Si la cadence est de durée fixe, le temps écoulé est simulé par des ticks de durée fixe (voir setFixedTimeStep()).
 //! Poursuit la génération du tick si nécessaire.
 void GameCanvas::onTick() {
-    long long elapsedTime = m_lastUpdateTime.elapsed();
+    qint64 elapsedTimeNs = m_lastUpdateTime.nsecsElapsed();
+    long long elapsedTime = elapsedTimeNs / NANOSECONDS_PER_MILLISECOND;
 
     // On évite une division par zéro (peu probable, mais on sait jamais)
     if (elapsedTime < 1)
@@ -331,8 +393,7 @@ void GameCanvas::onTick() {
 #endif
 
     // Tick
-    m_pGameCore->tick(elapsedTime);
-    currentScene()->tick(elapsedTime);
+    simulate(elapsedTimeNs);
 
     if (m_pDetailedInfosItem && m_pDetailedInfosItem->isVisible())
         m_pDetailedInfosItem->setPlainText(QString("FPS : %1, Elapsed : %2ms, Tick duration : %3ms")
@@ -355,6 +416,50 @@ void GameCanvas::onTick() {
 #endif
 }
 
+//! Fait avancer le jeu du temps donné, sans mesurer le temps réellement écoulé.
+//! Permet de piloter le jeu depuis une simple boucle, par exemple en mode sans affichage
+//! (voir main_headless.cpp), aussi vite que le processeur le permet.
+//! Si la cadence est de durée fixe, le temps donné est simulé par des ticks de durée fixe.
+//! \param elapsedTimeInMilliseconds  Temps à simuler.
+void GameCanvas::step(long long elapsedTimeInMilliseconds) {
+    simulate(elapsedTimeInMilliseconds * NANOSECONDS_PER_MILLISECOND);
+}
+
+//! Fait avancer le jeu du temps donné, selon le mode de cadence choisi.
+//! \param elapsedTimeNs  Temps écoulé, en nanosecondes.
+void GameCanvas::simulate(qint64 elapsedTimeNs) {
+    if (m_isFixedTimeStep) {
+        tickFixedSteps(elapsedTimeNs);
+    } else {
+        // On évite une durée nulle (peu probable, mais on sait jamais)
+        long long elapsedTime = qMax<qint64>(1, elapsedTimeNs / NANOSECONDS_PER_MILLISECOND);
+        m_pGameCore->tick(elapsedTime);
+        currentScene()->tick(elapsedTime);
+    }
+}
+
+//! Exécute autant de ticks de durée fixe que le temps écoulé le permet, puis interpole
+//! l'affichage des sprites avec le temps restant.
+//! \param elapsedTimeNs  Temps écoulé depuis le déclenchement précédent du timer, en nanosecondes.
+void GameCanvas::tickFixedSteps(qint64 elapsedTimeNs) {
+    const qint64 stepDurationNs = static_cast<qint64>(m_fixedStepDuration) * NANOSECONDS_PER_MILLISECOND;
+    m_accumulatedTimeNs += elapsedTimeNs;
+
+    int stepCount = 0;
+    while (m_accumulatedTimeNs >= stepDurationNs && stepCount < m_maxSubsteps) {
+        m_pGameCore->tick(m_fixedStepDuration);
+        currentScene()->tick(m_fixedStepDuration);
+        m_accumulatedTimeNs -= stepDurationNs;
+        stepCount++;
+    }
+
+    // Trop de retard : le temps qui n'a pas pu être simulé est abandonné
+    if (m_accumulatedTimeNs >= stepDurationNs)
+        m_accumulatedTimeNs %= stepDurationNs;
+
+    currentScene()->interpolate(static_cast<qreal>(m_accumulatedTimeNs) / stepDurationNs);
+}
+
 #ifdef QT_DEBUG
 //! Remet à zéro les compteurs pour les statistiques en mode debug.
 void GameCanvas::resetStatistics() {
@@ -48,19 +48,36 @@ class QKeyEvent;
 //!
 //! Pour stopper le tick, utiliser la commande stopTick().
 //!
+//! Par défaut, la durée transmise à chaque tick est le temps réellement écoulé depuis le tick
+//! précédent : la simulation dépend donc de la régularité du timer. La méthode setFixedTimeStep()
+//! permet de simuler le jeu avec des ticks de durée fixe, indépendants de la cadence d'affichage :
+//! le temps écoulé est accumulé, et autant de ticks de durée fixe que nécessaire (au maximum
+//! maxSubsteps) sont exécutés à chaque déclenchement du timer. Le temps restant, inférieur à la
+//! durée d'un tick, sert à interpoler l'affichage des sprites entre leurs deux dernières
+//! positions (GameScene::interpolate()). La méthode setVariableTimeStep() rétablit le mode par défaut.
+//!
 //! GameCanvas permet également d'enclencher le suivi des déplacements de la souris (startMouseTracking() et de
 //! le stopper (stopMouseTracking()).
 //!
 //! Si GameCanvas émet le signal requestToCloseApp(), cela provoque la fermeture de l'application.
+//!
+//! GameCanvas peut également être construit sans vue (pView nul), afin de faire fonctionner le jeu
+//! sans affichage (isHeadless()), par exemple pour des mesures de performances ou des parties
+//! automatisées sur un serveur. GameCore est alors créé dès la construction, le timer n'est pas
+//! utilisé et le jeu avance uniquement lorsque step() est appelé, aussi vite que le processeur le permet.
 class GameCanvas : public QObject
 {
     Q_OBJECT
 public:
     enum { KEEP_PREVIOUS_TICK_INTERVAL = -1  };
+    enum { DEFAULT_MAX_SUBSTEPS = 5 };
 
     explicit GameCanvas(GameView* pView, QObject* pParent = nullptr);
     ~GameCanvas() override;
 
+    bool isHeadless() const { return m_pView == nullptr; }
+    GameCore* gameCore() const { return m_pGameCore; }
+
 
     GameScene* createScene();
     GameScene* createScene(const QRectF& rSceneRect);
@@ -76,6 +93,13 @@ public:
     void stopTick();
     bool isTicking() const;
 
+    void setFixedTimeStep(int stepRate, int maxSubsteps = DEFAULT_MAX_SUBSTEPS);
+    void setVariableTimeStep();
+    bool isFixedTimeStep() const { return m_isFixedTimeStep; }
+    int fixedStepDuration() const { return m_fixedStepDuration; }
+
+    void step(long long elapsedTimeInMilliseconds);
+
     void startMouseTracking();
     void stopMouseTracking();
     QPointF currentMousePosition() const;
@@ -93,6 +117,8 @@ protected:
 
 private:
     void initDetailedInfos();
+    void simulate(qint64 elapsedTimeNs);
+    void tickFixedSteps(qint64 elapsedTimeNs);
 
     void keyPressed(QKeyEvent* pKeyEvent);
     void keyReleased(QKeyEvent* pKeyEvent);
@@ -102,6 +128,7 @@ private:
     void mouseButtonReleased(QGraphicsSceneMouseEvent* pMouseEvent);
 
     GameView* m_pView;
+    GameScene* m_pCurrentScene;
     GameCore* m_pGameCore;
     QPointer<QGraphicsTextItem> m_pDetailedInfosItem; // Smart Pointer pour qu'il soit mis à zéro au cas où l'item est effacé par GameScene::clear()
 
@@ -111,6 +138,11 @@ private:
     QElapsedTimer m_lastUpdateTime;
     QTimer m_tickTimer;
 
+    bool m_isFixedTimeStep;
+    int m_fixedStepDuration;    // Durée d'un tick de durée fixe, en millisecondes
+    int m_maxSubsteps;          // Nombre maximal de ticks de durée fixe par tick du timer
+    qint64 m_accumulatedTimeNs; // Temps écoulé pas encore simulé
+
 #ifdef QT_DEBUG
     void resetStatistics();
 
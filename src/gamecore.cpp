@@ -17,10 +17,10 @@
 #include "utilities.h"
 #include "Player.h"
 #include "LevelLoader.h"
-#include "Particle.h"
 #include "MovingPlatform.h"
 
 const int SCENE_WIDTH = 3500;
+const int SIMULATION_RATE = 50; // Ticks de simulation par seconde
 
 //! Initialise le contrôleur de jeu.
 //! \param pGameCanvas  GameCanvas pour lequel cet objet travaille.
@@ -50,6 +50,9 @@ GameCore::GameCore(GameCanvas* pGameCanvas, QObject* pParent) : QObject(pParent)
     // Attention : il est important que l'enclenchement du tick soit fait vers la fin de cette fonction,
     // sinon le temps passé jusqu'au premier tick (ElapsedTime) peut être élevé et provoquer de gros
     // déplacements, surtout si le débogueur est démarré.
+    // La simulation est faite à cadence fixe, afin que la physique (gravité, sauts, dash) ne dépende pas
+    // de la régularité du timer.
+    m_pGameCanvas->setFixedTimeStep(SIMULATION_RATE);
     m_pGameCanvas->startTick();
 }
 
@@ -7,6 +7,7 @@
 #include "gamescene.h"
 
 #include <cstdlib>
+#include <utility>
 #include <QApplication>
 #include <QBrush>
 #include <QDebug>
@@ -22,14 +23,14 @@
 
 //! Construit la scène de jeu avec une taille par défaut et un fond noir.
 //! \param pParent  Objet propriétaire de cette scène.
-GameScene::GameScene(QObject* pParent) : QGraphicsScene(pParent) {
+GameScene::GameScene(QObject* pParent) : QGraphicsScene(pParent), m_effectPool(this) {
     init();
 }
 
 //! Construit la scène de jeu avec la taille donnée et un fond noir.
 //! \param rSceneRect   Taille de la scène.
 //! \param pParent      Objet propriétaire de cette scène.
-GameScene::GameScene(const QRectF& rSceneRect, QObject* pParent) : QGraphicsScene(rSceneRect, pParent) {
+GameScene::GameScene(const QRectF& rSceneRect, QObject* pParent) : QGraphicsScene(rSceneRect, pParent), m_effectPool(this) {
     init();
 }
 
@@ -39,7 +40,7 @@ GameScene::GameScene(const QRectF& rSceneRect, QObject* pParent) : QGraphicsScen
 //! \param width    Largeur de la scène.
 //! \param height   Hauteur de la scène.
 //! \param pParent  Objet propriétaire de cette scène.
-GameScene::GameScene(qreal X, qreal Y, qreal width, qreal height, QObject* pParent) : QGraphicsScene(X, Y, width, height, pParent) {
+GameScene::GameScene(qreal X, qreal Y, qreal width, qreal height, QObject* pParent) : QGraphicsScene(X, Y, width, height, pParent), m_effectPool(this) {
     init();
 }
 
@@ -68,6 +69,17 @@ void GameScene::addSpriteToScene(Sprite* pSprite)
 
     this->addItem(pSprite);
     pSprite->setParentScene(this);
+    if (!m_spriteIndexes.contains(pSprite)) {
+        m_spriteIndexes.insert(pSprite, static_cast<int>(m_spriteList.count()));
+        m_spriteList.append(pSprite);
+    }
+    if (pSprite->isStatic()) {
+        m_staticSprites.insert(pSprite, pSprite->globalBoundingRect());
+        m_staticTreeDirty = true;
+    } else {
+        m_spatialGrid.insert(pSprite, pSprite->globalBoundingRect());
+        addToBroadPhase(pSprite);
+    }
 
     connect(pSprite, &Sprite::spriteDestroyed, this, &GameScene::onSpriteDestroyed);
     emit spriteAddedToScene(pSprite);
@@ -80,8 +92,9 @@ void GameScene::addSpriteToScene(Sprite* pSprite)
 //! \param posY    Position Y du sprite
 void GameScene::addSpriteToScene(Sprite* pSprite, double posX, double posY)
 {
-    addSpriteToScene(pSprite);
+    // Positionné avant l'ajout, afin qu'un sprite statique ne soit pas considéré comme déplacé.
     pSprite->setPos(posX, posY);
+    addSpriteToScene(pSprite);
 }
 
 //! Retire le sprite de la scène.
@@ -90,10 +103,11 @@ void GameScene::addSpriteToScene(Sprite* pSprite, double posX, double posY)
 void GameScene::removeSpriteFromScene(Sprite* pSprite)
 {
     removeItem(pSprite);
+    unregisterSprite(pSprite);
 
     disconnect(pSprite, &Sprite::spriteDestroyed, this, &GameScene::onSpriteDestroyed);
 
-    m_registeredForTickSpriteList.removeAll(pSprite);
+    unregisterSpriteFromTick(pSprite);
 
     emit spriteRemovedFromScene(pSprite);
 }
@@ -116,20 +130,126 @@ QList<Sprite*> GameScene::collidingSprites(const Sprite* pSprite) const {
 
 //! Construit la liste de tous les sprites en collision avec le rectangle donné
 //! en paramètre.
-//! Si la scène contient de nombreux sprites, cette méthode peut prendre du temps.
+//! Seuls les sprites ajoutés avec addSpriteToScene() sont pris en compte.
+//! L'arbre des sprites statiques fournit directement les sprites statiques en collision.
+//! La grille spatiale fournit les sprites dynamiques proches du rectangle, dont seule
+//! l'intersection exacte est ensuite vérifiée.
 //! \param rRect Rectangle avec lequel il faut tester les collisions.
 //! \return une liste de sprites en collision.
 QList<Sprite*> GameScene::collidingSprites(const QRectF &rRect) const  {
+    if (m_staticTreeDirty)
+        rebuildStaticTree();
+
     QList<Sprite*> collidingSpriteList;
-    for(Sprite* pSprite : sprites())  {
-        QRectF globalBBox = pSprite->globalBoundingRect();
-        if (globalBBox.intersects(rRect)) {
-            collidingSpriteList << pSprite;
+    m_staticTree.query(rRect, collidingSpriteList);
+    const int staticCount = static_cast<int>(collidingSpriteList.size());
+    m_spatialGrid.query(rRect, collidingSpriteList);
+
+    // Élimine les candidats dynamiques qui ne sont pas réellement en collision
+    int collidingCount = staticCount;
+    for(int i = staticCount; i < collidingSpriteList.size(); i++)  {
+        Sprite* pSprite = collidingSpriteList.at(i);
+        if (pSprite->globalBoundingRect().intersects(rRect)) {
+            collidingSpriteList[collidingCount++] = pSprite;
         }
     }
+    collidingSpriteList.resize(collidingCount);
     return collidingSpriteList;
 }
 
+//! Construit la liste de tous les sprites en collision avec le rectangle donné
+//! en paramètre, recherchés pour le compte du sprite donné.
+//! Durant le tick, si le rectangle est couvert par la phase large du sprite qui fait
+//! la recherche, seuls les sprites dynamiques proches trouvés par la phase large sont
+//! testés, sans interroger la grille spatiale. Sinon, équivaut à collidingSprites(rRect).
+//! Le sprite qui fait la recherche ne fait pas partie de la liste retournée.
+//! \param rRect     Rectangle avec lequel il faut tester les collisions.
+//! \param pQuerier  Sprite qui fait la recherche.
+//! \return une liste de sprites en collision.
+QList<Sprite*> GameScene::collidingSprites(const QRectF& rRect, const Sprite* pQuerier) const {
+    auto indexIt = m_broadPhaseIndexes.constFind(pQuerier);
+    if (!m_isBroadPhaseValid || indexIt == m_broadPhaseIndexes.constEnd()
+        || !m_broadPhaseEntries.at(indexIt.value()).rect.contains(rRect)) {
+        QList<Sprite*> collidingSpriteList = collidingSprites(rRect);
+        collidingSpriteList.removeAll(const_cast<Sprite*>(pQuerier));
+        return collidingSpriteList;
+    }
+
+    if (m_staticTreeDirty)
+        rebuildStaticTree();
+
+    QList<Sprite*> collidingSpriteList;
+    m_staticTree.query(rRect, collidingSpriteList);
+
+    for (Sprite* pSprite : m_broadPhaseCandidates.at(indexIt.value())) {
+        // Le candidat a pu quitter la scène ou sortir de son rectangle depuis le début du tick
+        auto candidateIt = m_broadPhaseIndexes.constFind(pSprite);
+        if (candidateIt == m_broadPhaseIndexes.constEnd() || m_broadPhaseEntries.at(candidateIt.value()).escaped)
+            continue;
+
+        if (pSprite->globalBoundingRect().intersects(rRect))
+            collidingSpriteList << pSprite;
+    }
+
+    for (Sprite* pSprite : m_broadPhaseLateSprites) {
+        if (pSprite != pQuerier && pSprite->globalBoundingRect().intersects(rRect))
+            collidingSpriteList << pSprite;
+    }
+
+    return collidingSpriteList;
+}
+
+//! Construit, en une seule recherche, la liste des sprites en collision avec chacun
+//! des rectangles donnés en paramètre, recherchés pour le compte du sprite donné.
+//! L'arbre statique, la phase large ou la grille spatiale ne sont parcourus qu'une
+//! fois, avec le rectangle englobant tous les rectangles donnés. Chaque sprite trouvé
+//! est ensuite réparti dans la liste de chaque rectangle avec lequel il est en collision.
+//! Un sprite peut ainsi figurer dans plusieurs listes.
+//! \param rRects    Rectangles avec lesquels il faut tester les collisions.
+//! \param pQuerier  Sprite qui fait la recherche.
+//! \return une liste de sprites en collision par rectangle, dans l'ordre des rectangles donnés.
+QList<QList<Sprite*>> GameScene::collidingSprites(const QList<QRectF>& rRects, const Sprite* pQuerier) const {
+    QList<QList<Sprite*>> collidingSpriteLists(rRects.size());
+    if (rRects.isEmpty())
+        return collidingSpriteLists;
+
+    QRectF unitedRect = rRects.first();
+    for (const QRectF& rRect : rRects)
+        unitedRect |= rRect;
+
+    const auto candidateList = collidingSprites(unitedRect, pQuerier);
+    if (rRects.size() == 1) {
+        collidingSpriteLists[0] = candidateList;
+        return collidingSpriteLists;
+    }
+
+    for (Sprite* pSprite : candidateList) {
+        const QRectF spriteRect = pSprite->globalBoundingRect();
+        for (int i = 0; i < rRects.size(); i++) {
+            if (spriteRect.intersects(rRects.at(i)))
+                collidingSpriteLists[i] << pSprite;
+        }
+    }
+    return collidingSpriteLists;
+}
+
+//! Construit, en une seule recherche, la liste des sprites en collision avec le rectangle
+//! donné, ainsi qu'avec ce même rectangle décalé de chacun des décalages (sondes) donnés.
+//! Équivaut à collidingSprites(const QList<QRectF>&, const Sprite*).
+//! \param rRect          Rectangle avec lequel il faut tester les collisions.
+//! \param rProbeOffsets  Décalages des sondes par rapport au rectangle.
+//! \param pQuerier       Sprite qui fait la recherche.
+//! \return la liste des sprites en collision avec le rectangle, suivie d'une liste par sonde.
+QList<QList<Sprite*>> GameScene::collidingSprites(const QRectF& rRect, const QList<QPointF>& rProbeOffsets,
+                                                  const Sprite* pQuerier) const {
+    QList<QRectF> rectList;
+    rectList.reserve(rProbeOffsets.size() + 1);
+    rectList << rRect;
+    for (const QPointF& rOffset : rProbeOffsets)
+        rectList << rRect.translated(rOffset);
+    return collidingSprites(rectList, pQuerier);
+}
+
 //! Construit la liste de tous les sprites en collision avec la forme donnée
 //! en paramètre.
 //! Si la scène contient de nombreux sprites, cette méthode peut prendre du temps.
@@ -147,16 +267,44 @@ QList<Sprite*> GameScene::collidingSprites(const QPainterPath& rShape) const {
 }
 
 //!
+//! La liste est tenue à jour par la scène et n'est pas reconstruite à chaque appel :
+//! la copie retournée est partagée implicitement (Qt) avec la liste interne et ne
+//! coûte qu'une allocation si la scène ajoute ou retire un sprite pendant que la
+//! copie est parcourue.
+//! Seuls les sprites ajoutés avec addSpriteToScene() sont pris en compte.
+//! L'ordre des sprites dans la liste n'est pas garanti.
 //! \return la liste des sprites de cette scène (y compris ceux qui ne sont pas visibles).
 //!
 QList<Sprite*> GameScene::sprites() const  {
-    QList<Sprite*> spriteList;
-    auto allItems = this->items();
-    for(QGraphicsItem* pItem : allItems) {
-        if (pItem->type() == Sprite::SpriteItemType)
-            spriteList << static_cast<Sprite*>(pItem);
-    }
-    return spriteList;
+    return m_spriteList;
+}
+
+//! Indique si le sprite donné a été ajouté à cette scène avec addSpriteToScene().
+//! \param pSprite Sprite à vérifier.
+//! \return un booléen à vrai si le sprite fait partie de la scène.
+bool GameScene::containsSprite(const Sprite* pSprite) const {
+    return m_spriteIndexes.contains(pSprite);
+}
+
+//! Construit l'arbre de collision des sprites statiques.
+//! Ne fait rien si les sprites statiques n'ont pas changé depuis la dernière construction.
+//! Cette méthode devrait être appelée une fois le niveau chargé, afin que l'arbre
+//! ne soit pas construit lors de la première recherche de collision.
+//! Elle est sinon appelée automatiquement par collidingSprites().
+void GameScene::bakeStaticSprites() {
+    if (m_staticTreeDirty)
+        rebuildStaticTree();
+}
+
+//! Reconstruit l'arbre de collision à partir des sprites statiques actuels.
+void GameScene::rebuildStaticTree() const {
+    QList<StaticCollisionTree::Item> items;
+    items.reserve(m_staticSprites.count());
+    for (auto it = m_staticSprites.constBegin(); it != m_staticSprites.constEnd(); ++it)
+        items << StaticCollisionTree::Item { it.key(), it.value() };
+
+    m_staticTree.build(std::move(items));
+    m_staticTreeDirty = false;
 }
 
 //! Récupère le sprite visible le plus en avant se trouvant à la position donnée.
@@ -218,24 +366,63 @@ void GameScene::setHeight(int sceneHeight)  {
     setSceneRect(0,0, width(), sceneHeight);
 }
 
-//! Le sprite donné sera informé du tick.
+//! Le sprite donné sera informé du tick, durant la phase donnée.
+//! Un sprite peut s'abonner à plusieurs phases.
 //! \param pSprite Sprite qui s'enregistre pour le tick.
-void GameScene::registerSpriteForTick(Sprite* pSprite) {
-    m_registeredForTickSpriteList.append(pSprite);
+//! \param phase   Phase du tick durant laquelle le sprite est appelé.
+void GameScene::registerSpriteForTick(Sprite* pSprite, TickPhase phase) {
+    // Un sprite suspendu sera abonné à cette phase lorsqu'il sera réactivé
+    auto suspendedIt = m_suspendedSprites.find(pSprite);
+    if (suspendedIt != m_suspendedSprites.end()) {
+        suspendedIt.value() |= 1 << phase;
+        return;
+    }
+
+    m_tickRegistries[phase].add(pSprite);
 }
 
-//! Le sprite donné se va plus être informé du tick.
+//! Le sprite donné se va plus être informé du tick, quelle que soit la phase.
 //! \param pSprite Sprite qui démissionne du tick.
 void GameScene::unregisterSpriteFromTick(Sprite* pSprite) {
-    m_registeredForTickSpriteList.removeAll(pSprite);
+    for (TickRegistry& rRegistry : m_tickRegistries)
+        rRegistry.remove(pSprite);
+
+    auto suspendedIt = m_suspendedSprites.find(pSprite);
+    if (suspendedIt != m_suspendedSprites.end())
+        suspendedIt.value() &= ANIMATION_SUSPENDED;
 }
 
-//! Indique si le sprite donné est abonné au tick.
+//! Le sprite donné se va plus être informé de la phase donnée du tick.
+//! \param pSprite Sprite qui démissionne de la phase.
+//! \param phase   Phase du tick.
+void GameScene::unregisterSpriteFromTick(Sprite* pSprite, TickPhase phase) {
+    m_tickRegistries[phase].remove(pSprite);
+
+    auto suspendedIt = m_suspendedSprites.find(pSprite);
+    if (suspendedIt != m_suspendedSprites.end())
+        suspendedIt.value() &= ~(1 << phase);
+}
+
+//! Indique si le sprite donné est abonné au tick, quelle que soit la phase.
 //! \param pSprite Sprite à vérifier.
 //! \return un booléen à vrai si le sprite donné est abonné au tick.
 bool GameScene::isRegisteredForTick(const Sprite* pSprite) const
 {
-    return m_registeredForTickSpriteList.contains(pSprite);
+    for (const TickRegistry& rRegistry : m_tickRegistries) {
+        if (rRegistry.contains(pSprite))
+            return true;
+    }
+    return (m_suspendedSprites.value(const_cast<Sprite*>(pSprite)) & ~ANIMATION_SUSPENDED) != 0;
+}
+
+//! Indique si le sprite donné est abonné à la phase donnée du tick.
+//! \param pSprite Sprite à vérifier.
+//! \param phase   Phase du tick.
+//! \return un booléen à vrai si le sprite donné est abonné à cette phase.
+bool GameScene::isRegisteredForTick(const Sprite* pSprite, TickPhase phase) const
+{
+    return m_tickRegistries[phase].contains(pSprite)
+           || (m_suspendedSprites.value(const_cast<Sprite*>(pSprite)) & (1 << phase)) != 0;
 }
 
 //! Vérifie si la position donnée fait partie de la scène.
@@ -258,30 +445,182 @@ bool GameScene::isInsideScene(const QRectF& rRect) const {
 }
 
 //! Centre la vue GameView sur le sprite donné.
+//! Si la scène n'est affichée par aucune vue (mode sans affichage), ne fait rien.
+//! Lorsque l'affichage est interpolé (voir interpolate()), la vue suit la position affichée du sprite.
 //! \param pSprite Sprite sur lequel la vue doit être centrée.
 void GameScene::centerViewOn(const Sprite* pSprite) {
-    Q_ASSERT(!views().isEmpty());
+    m_pCenteredSprite = pSprite;
+
+    // Sans affichage, il n'y a rien à centrer
+    if (views().isEmpty())
+        return;
 
-    views().at(0)->centerOn(pSprite);
+    // Le rectangle de dessin du sprite comprend son décalage d'affichage : la vue se centre sur sa position
+    views().at(0)->centerOn(pSprite->globalBoundingRect().center());
 }
 
 //! Centre la vue GameView sur la position donnée.
+//! Si la scène n'est affichée par aucune vue (mode sans affichage), ne fait rien.
 //! \param pos Position sur laquelle la vue doit être centrée.
 void GameScene::centerViewOn(QPointF pos) {
-    Q_ASSERT(!views().isEmpty());
+    m_pCenteredSprite = nullptr;
+
+    // Sans affichage, il n'y a rien à centrer
+    if (views().isEmpty())
+        return;
 
     views().at(0)->centerOn(pos);
 }
 
+//! Active ou désactive la région d'activation.
+//! Lorsqu'elle est désactivée, tous les sprites suspendus sont réactivés et plus aucun sprite n'est suspendu.
+//! \param enabled Indique si les sprites éloignés de la partie affichée doivent être suspendus.
+void GameScene::setActivationRegionEnabled(bool enabled) {
+    m_isActivationRegionEnabled = enabled;
+    if (!enabled)
+        updateActivation();
+}
+
+//! Détermine les marges ajoutées autour de la partie affichée pour former la région d'activation.
+//! Des marges plus grandes réactivent les sprites plus tôt, au prix de plus de sprites actifs.
+//! \param horizontalMargin  Marge à gauche et à droite, en pixels.
+//! \param verticalMargin    Marge en haut et en bas, en pixels.
+void GameScene::setActivationMargins(qreal horizontalMargin, qreal verticalMargin) {
+    m_horizontalActivationMargin = horizontalMargin;
+    m_verticalActivationMargin = verticalMargin;
+}
+
+//! \return la région de la scène dans laquelle les sprites sont actifs, ou un rectangle nul si
+//! la région d'activation est désactivée ou si la scène n'est affichée par aucune vue.
+QRectF GameScene::activationRegion() const {
+    if (!m_isActivationRegionEnabled || views().isEmpty())
+        return QRectF();
+
+    QGraphicsView* pView = views().at(0);
+    QRectF visibleRect = pView->mapToScene(pView->viewport()->rect()).boundingRect();
+    return visibleRect.adjusted(-m_horizontalActivationMargin, -m_verticalActivationMargin,
+                                m_horizontalActivationMargin, m_verticalActivationMargin);
+}
+
+//! Indique si le sprite donné est suspendu car trop éloigné de la partie affichée.
+//! \param pSprite Sprite à vérifier.
+//! \return un booléen à vrai si le sprite est suspendu.
+bool GameScene::isSuspended(const Sprite* pSprite) const {
+    return m_suspendedSprites.contains(const_cast<Sprite*>(pSprite));
+}
+
 //! Cadence.
+//! Les phases du tick (TickPhase) sont appelées dans l'ordre, chacune pour tous les sprites qui y sont abonnés.
 //! \param elapsedTimeInMilliseconds  Temps écoulé depuis le tick précédent.
 void GameScene::tick(long long elapsedTimeInMilliseconds) {
-    auto spriteListCopy = m_registeredForTickSpriteList; // On travaille sur une copie au cas où
-                                        // la liste originale serait modifiée
-                                        // lors de l'appel de tick auprès d'un sprite.
-    for(Sprite* pSprite : spriteListCopy) {
-        pSprite->tick(elapsedTimeInMilliseconds);
+    // Les délais échus sont déclenchés avant la phase large, qui tient ainsi compte de leurs effets
+    m_timerWheel.advance(elapsedTimeInMilliseconds);
+
+    updateActivation();
+
+    updateBroadPhase(elapsedTimeInMilliseconds);
+
+    captureTickStartStates();
+
+    dispatchTickPhase(InputPhase, elapsedTimeInMilliseconds);
+    dispatchTickPhase(PrePhysicsPhase, elapsedTimeInMilliseconds);
+    dispatchTickPhase(PhysicsPhase, elapsedTimeInMilliseconds);
+    dispatchTickPhase(PostPhysicsPhase, elapsedTimeInMilliseconds);
+
+    m_isBroadPhaseValid = false;
+
+    // Les contacts du tick sont notifiés une fois tous les sprites déplacés
+    m_contactEventQueue.flush();
+
+    dispatchTickPhase(AnimationPhase, elapsedTimeInMilliseconds);
+    advanceAnimations(elapsedTimeInMilliseconds);
+
+    dispatchTickPhase(CameraPhase, elapsedTimeInMilliseconds);
+
+    captureTickEndStates();
+}
+
+//! Appelle la phase donnée du tick auprès de tous les sprites qui y sont abonnés.
+//! Un sprite qui s'abonne à une phase qui n'a pas encore été appelée (par exemple une entité
+//! réveillée par une plateforme mobile) est appelé dès ce tick.
+//! \param phase                      Phase du tick.
+//! \param elapsedTimeInMilliseconds  Temps écoulé depuis le tick précédent.
+void GameScene::dispatchTickPhase(TickPhase phase, long long elapsedTimeInMilliseconds) {
+    // Jusqu'à la fin de la phase, les sprites qui s'abonnent ou se désabonnent (lors de l'appel
+    // de tick auprès d'un sprite, par exemple) ne modifient pas la taille de la liste.
+    TickRegistry& rRegistry = m_tickRegistries[phase];
+    rRegistry.beginDispatch();
+
+    const QList<Sprite*>& rTickSprites = rRegistry.sprites();
+    for(int i = 0; i < rTickSprites.size(); i++) {
+        Sprite* pSprite = rTickSprites.at(i);
+        if (pSprite != nullptr) // Nul si le sprite s'est désabonné durant cette phase
+            pSprite->phaseTick(phase, elapsedTimeInMilliseconds);
     }
+
+    rRegistry.endDispatch();
+}
+
+//! Mémorise la position de départ de l'interpolation de l'affichage de chaque sprite abonné au tick.
+//! Un sprite abonné à plusieurs phases n'est mémorisé qu'une fois, pour la première d'entre elles.
+//! Les sprites interpolés lors du tick précédent sont d'abord à nouveau affichés à leur position.
+void GameScene::captureTickStartStates() {
+    for (const SpriteRenderState& rState : std::as_const(m_renderStates)) {
+        if (rState.pSprite)
+            rState.pSprite->setRenderOffset(QPointF());
+    }
+
+    m_renderStates.clear();
+    for (int phase = 0; phase < TickPhaseCount; phase++) {
+        for (Sprite* pSprite : m_tickRegistries[phase].sprites()) {
+            bool isCaptured = false;
+            for (int previousPhase = 0; previousPhase < phase && !isCaptured; previousPhase++)
+                isCaptured = m_tickRegistries[previousPhase].contains(pSprite);
+
+            if (!isCaptured)
+                m_renderStates << SpriteRenderState{pSprite, pSprite->scenePos(), pSprite->scenePos()};
+        }
+    }
+}
+
+//! Détermine l'avancement de l'affichage entre le début et la fin du dernier tick.
+//! Les sprites abonnés au tick sont affichés entre leur position au début du dernier tick
+//! et leur position actuelle. Appelé par GameCanvas lorsque la cadence est de durée fixe,
+//! afin que l'affichage reste fluide même s'il est plus fréquent que les ticks.
+//! Un sprite dont le décalage change en informe la scène (Sprite::setRenderOffset()), qui ne
+//! redessine que l'ancienne et la nouvelle zone de ce sprite : les autres parties de la scène
+//! ne sont pas redessinées. Les sprites qui s'interpolent eux-mêmes sont redessinés.
+//! \param progress  Avancement depuis le dernier tick, de 0 à 1 (1 : positions actuelles).
+void GameScene::interpolate(qreal progress) {
+    m_renderProgress = progress;
+    for (const SpriteRenderState& rState : std::as_const(m_renderStates)) {
+        if (!rState.pSprite)
+            continue;
+
+        rState.pSprite->setRenderOffset(interpolatedOffset(rState));
+        if (rState.pSprite->hasCapability(Sprite::SelfInterpolatedCapability))
+            rState.pSprite->update();
+    }
+
+    // La vue suit la position affichée du sprite qu'elle centre
+    if (m_pCenteredSprite && !views().isEmpty())
+        views().at(0)->centerOn(m_pCenteredSprite->globalBoundingRect().center() + m_pCenteredSprite->renderOffset());
+}
+
+//! Mémorise la position d'arrivée de l'interpolation de l'affichage des sprites abonnés au tick.
+//! Les sprites qui se sont désabonnés du tick durant le tick ne sont plus interpolés.
+void GameScene::captureTickEndStates() {
+    for (SpriteRenderState& rState : m_renderStates) {
+        if (rState.pSprite && isRegisteredForTick(rState.pSprite))
+            rState.currentPos = rState.pSprite->scenePos();
+        else
+            rState.pSprite = nullptr;
+    }
+}
+
+//! \return le décalage d'affichage d'un sprite, selon l'avancement de l'affichage.
+QPointF GameScene::interpolatedOffset(const SpriteRenderState& rState) const {
+    return (rState.previousPos - rState.currentPos) * (1.0 - m_renderProgress);
 }
 
 //! Dessine le fond d'écran de la scène.
@@ -299,6 +638,13 @@ void GameScene::drawBackground(QPainter* pPainter, const QRectF& rRect)  {
 //! Initialise la scène
 void GameScene::init() {
     m_pBackgroundImage = nullptr;
+    m_staticTreeDirty = false;
+    m_isBroadPhaseValid = false;
+    m_pCenteredSprite = nullptr;
+    m_renderProgress = 1.0;
+    m_isActivationRegionEnabled = true;
+    m_horizontalActivationMargin = DEFAULT_ACTIVATION_MARGIN;
+    m_verticalActivationMargin = DEFAULT_ACTIVATION_MARGIN;
 
     this->setBackgroundBrush(QBrush(Qt::black));
     //setBackgroundImage(QImage(GameFramework::imagesPath("demo/landscape_background.jpg"));
@@ -309,7 +655,328 @@ void GameScene::init() {
 
 }
 
+//! Met à jour la position du sprite donné dans la grille spatiale.
+//! Appelé par le sprite lorsque sa géométrie (position, transformation ou image) change.
+//! \param pSprite Sprite qui a changé.
+void GameScene::updateSpriteGeometry(Sprite* pSprite) {
+    auto it = m_staticSprites.find(pSprite);
+    if (it == m_staticSprites.end()) {
+        QRectF spriteRect = pSprite->globalBoundingRect();
+        m_spatialGrid.update(pSprite, spriteRect);
+
+        // Un sprite qui sort du rectangle prévu par la phase large doit être testé
+        // par toutes les recherches de collisions du tick en cours.
+        if (m_isBroadPhaseValid) {
+            auto indexIt = m_broadPhaseIndexes.constFind(pSprite);
+            if (indexIt != m_broadPhaseIndexes.constEnd()) {
+                BroadPhaseEntry& rEntry = m_broadPhaseEntries[indexIt.value()];
+                if (!rEntry.escaped && !rEntry.rect.contains(spriteRect)) {
+                    rEntry.escaped = true;
+                    m_broadPhaseLateSprites << pSprite;
+                }
+            }
+        }
+        return;
+    }
+
+    // Un sprite statique qui se déplace devient dynamique, afin que l'arbre
+    // de collision ne soit pas reconstruit à chacun de ses déplacements.
+    if (it.value() != pSprite->globalBoundingRect())
+        pSprite->setStatic(false);
+}
+
+//! Déplace le sprite donné entre l'arbre des sprites statiques et la grille
+//! spatiale des sprites dynamiques.
+//! Appelé par le sprite lorsque Sprite::setStatic() change sa mobilité.
+//! \param pSprite Sprite qui a changé.
+void GameScene::updateSpriteMobility(Sprite* pSprite) {
+    if (!containsSprite(pSprite))
+        return;
+
+    if (pSprite->isStatic()) {
+        m_spatialGrid.remove(pSprite);
+        removeFromBroadPhase(pSprite);
+        m_staticSprites.insert(pSprite, pSprite->globalBoundingRect());
+        m_staticTreeDirty = true;
+    } else {
+        if (m_staticSprites.remove(pSprite) > 0)
+            m_staticTreeDirty = true;
+        m_spatialGrid.insert(pSprite, pSprite->globalBoundingRect());
+        addToBroadPhase(pSprite);
+    }
+}
+
+//! Retire le sprite donné de la liste des sprites et de la structure de collision qui le contient.
+//! Le dernier sprite de la liste prend la place du sprite retiré, afin que
+//! le retrait se fasse en temps constant.
+//! \param pSprite Sprite à retirer.
+void GameScene::unregisterSprite(Sprite* pSprite) {
+    m_contactEventQueue.remove(pSprite);
+    m_timerWheel.cancelAll(pSprite);
+    m_suspendedSprites.remove(pSprite);
+    unregisterSpriteFromAnimation(pSprite);
+    if (m_pCenteredSprite == pSprite)
+        m_pCenteredSprite = nullptr;
+    for (SpriteRenderState& rState : m_renderStates) {
+        if (rState.pSprite == pSprite) {
+            rState.pSprite = nullptr;
+            pSprite->setRenderOffset(QPointF());
+        }
+    }
+
+    if (m_staticSprites.remove(pSprite) > 0) {
+        m_staticTreeDirty = true;
+    } else {
+        m_spatialGrid.remove(pSprite);
+        removeFromBroadPhase(pSprite);
+    }
+
+    auto it = m_spriteIndexes.find(pSprite);
+    if (it == m_spriteIndexes.end())
+        return;
+
+    int index = it.value();
+    m_spriteIndexes.erase(it);
+
+    Sprite* pLastSprite = m_spriteList.last();
+    m_spriteList.removeLast();
+    if (pLastSprite != pSprite) {
+        m_spriteList[index] = pLastSprite;
+        m_spriteIndexes[pLastSprite] = index;
+    }
+}
+
+//! Le sprite donné verra son animation avancer à chaque tick.
+//! Appelé par le sprite lorsque son animation démarre.
+//! \param pSprite Sprite dont l'animation démarre.
+void GameScene::registerSpriteForAnimation(Sprite* pSprite) {
+    // Un sprite suspendu sera animé lorsqu'il sera réactivé
+    auto suspendedIt = m_suspendedSprites.find(pSprite);
+    if (suspendedIt != m_suspendedSprites.end()) {
+        suspendedIt.value() |= ANIMATION_SUSPENDED;
+        return;
+    }
+
+    if (m_animatedSpriteIndexes.contains(pSprite))
+        return;
+
+    m_animatedSpriteIndexes.insert(pSprite, static_cast<int>(m_animatedSpriteList.count()));
+    m_animatedSpriteList.append(pSprite);
+}
+
+//! L'animation du sprite donné n'avancera plus.
+//! Le dernier sprite animé prend la place du sprite retiré, afin que le retrait se fasse en temps constant.
+//! \param pSprite Sprite dont l'animation s'arrête.
+void GameScene::unregisterSpriteFromAnimation(Sprite* pSprite) {
+    auto suspendedIt = m_suspendedSprites.find(pSprite);
+    if (suspendedIt != m_suspendedSprites.end())
+        suspendedIt.value() &= ~ANIMATION_SUSPENDED;
+
+    auto it = m_animatedSpriteIndexes.find(pSprite);
+    if (it == m_animatedSpriteIndexes.end())
+        return;
+
+    int index = it.value();
+    m_animatedSpriteIndexes.erase(it);
+
+    Sprite* pLastSprite = m_animatedSpriteList.last();
+    m_animatedSpriteList.removeLast();
+    if (pLastSprite != pSprite) {
+        m_animatedSpriteList[index] = pLastSprite;
+        m_animatedSpriteIndexes[pLastSprite] = index;
+    }
+}
+
+//! Fait avancer l'animation de tous les sprites animés.
+//! \param elapsedTimeInMilliseconds  Temps écoulé depuis le tick précédent.
+void GameScene::advanceAnimations(long long elapsedTimeInMilliseconds) {
+    // On travaille sur une copie : un sprite peut démarrer ou arrêter une animation,
+    // ou quitter la scène, lorsqu'il change d'image (signal animationFinished()).
+    auto animatedSpriteListCopy = m_animatedSpriteList;
+    for (Sprite* pSprite : animatedSpriteListCopy) {
+        if (m_animatedSpriteIndexes.contains(pSprite)) // Le sprite est encore animé
+            pSprite->advanceAnimation(elapsedTimeInMilliseconds);
+    }
+}
+
+//! Suspend les sprites actifs qui se trouvent hors de la région d'activation et réactive les
+//! sprites suspendus qu'elle a atteints.
+//! Seuls les sprites actifs et les sprites contenus dans la région sont parcourus : le coût ne
+//! dépend pas du nombre de sprites suspendus.
+void GameScene::updateActivation() {
+    QRectF region = activationRegion();
+    if (region.isNull()) { // Pas de région : tous les sprites sont actifs
+        if (!m_suspendedSprites.isEmpty()) {
+            const QList<Sprite*> suspendedSprites = m_suspendedSprites.keys();
+            for (Sprite* pSprite : suspendedSprites)
+                resumeSprite(pSprite);
+        }
+        return;
+    }
+
+    // Un sprite n'est suspendu qu'un peu au-delà de la région, afin qu'un sprite à la limite
+    // ne soit pas suspendu et réactivé à chaque tick
+    QRectF suspensionRegion = region.adjusted(-ACTIVATION_HYSTERESIS, -ACTIVATION_HYSTERESIS,
+                                              ACTIVATION_HYSTERESIS, ACTIVATION_HYSTERESIS);
+    auto isOutside = [&suspensionRegion](const Sprite* pSprite) {
+        QRectF spriteRect = pSprite->globalBoundingRect();
+        // Un sprite sans taille ne peut pas être retrouvé par la région : il n'est jamais suspendu
+        return !pSprite->isAlwaysActive() && !spriteRect.isEmpty() && !suspensionRegion.intersects(spriteRect);
+    };
+
+    // Parcours depuis la fin : un sprite suspendu est remplacé par le dernier de la liste,
+    // déjà parcouru. Une suspension peut aussi raccourcir la liste d'une autre façon, d'où
+    // la vérification de l'indice.
+    for (const TickRegistry& rRegistry : m_tickRegistries) {
+        const QList<Sprite*>& rTickSprites = rRegistry.sprites();
+        for (int i = static_cast<int>(rTickSprites.size()) - 1; i >= 0; i--) {
+            if (i < rTickSprites.size() && isOutside(rTickSprites.at(i)))
+                suspendSprite(rTickSprites.at(i));
+        }
+    }
+    for (int i = static_cast<int>(m_animatedSpriteList.size()) - 1; i >= 0; i--) {
+        if (i < m_animatedSpriteList.size() && isOutside(m_animatedSpriteList.at(i)))
+            suspendSprite(m_animatedSpriteList.at(i));
+    }
+
+    if (m_suspendedSprites.isEmpty())
+        return;
+
+    const QList<Sprite*> spritesInRegion = collidingSprites(region);
+    for (Sprite* pSprite : spritesInRegion) {
+        if (m_suspendedSprites.contains(pSprite))
+            resumeSprite(pSprite);
+    }
+}
+
+//! Suspend le sprite donné : il est retiré des phases du tick et des animations, qui sont mémorisées.
+//! \param pSprite Sprite à suspendre.
+void GameScene::suspendSprite(Sprite* pSprite) {
+    int suspendedState = 0;
+    for (int phase = 0; phase < TickPhaseCount; phase++) {
+        if (m_tickRegistries[phase].contains(pSprite)) {
+            suspendedState |= 1 << phase;
+            m_tickRegistries[phase].remove(pSprite);
+        }
+    }
+    if (m_animatedSpriteIndexes.contains(pSprite)) {
+        suspendedState |= ANIMATION_SUSPENDED;
+        unregisterSpriteFromAnimation(pSprite);
+    }
+
+    m_suspendedSprites.insert(pSprite, suspendedState);
+}
+
+//! Réactive le sprite donné : il est à nouveau abonné aux phases du tick et aux animations mémorisées.
+//! Sans effet si le sprite n'est pas suspendu.
+//! \param pSprite Sprite à réactiver.
+void GameScene::resumeSprite(Sprite* pSprite) {
+    auto it = m_suspendedSprites.find(pSprite);
+    if (it == m_suspendedSprites.end())
+        return;
+
+    int suspendedState = it.value();
+    m_suspendedSprites.erase(it);
+
+    for (int phase = 0; phase < TickPhaseCount; phase++) {
+        if (suspendedState & (1 << phase))
+            m_tickRegistries[phase].add(pSprite);
+    }
+    if (suspendedState & ANIMATION_SUSPENDED)
+        registerSpriteForAnimation(pSprite);
+}
+
+//! Ajoute un sprite dynamique à la phase large.
+//! Il y sera intégré au prochain tick ; s'il est ajouté durant un tick, il est testé
+//! par toutes les recherches de collisions du tick en cours.
+//! \param pSprite Sprite à ajouter.
+void GameScene::addToBroadPhase(Sprite* pSprite) {
+    if (m_broadPhaseIndexes.contains(pSprite) || m_broadPhasePendingSprites.contains(pSprite))
+        return;
+
+    m_broadPhasePendingSprites << pSprite;
+    if (m_isBroadPhaseValid)
+        m_broadPhaseLateSprites << pSprite;
+}
+
+//! Retire un sprite de la phase large.
+//! Son entrée est vidée et sera supprimée au prochain tick, afin que les indices
+//! des autres entrées restent valables durant le tick en cours.
+//! \param pSprite Sprite à retirer.
+void GameScene::removeFromBroadPhase(Sprite* pSprite) {
+    auto it = m_broadPhaseIndexes.find(pSprite);
+    if (it != m_broadPhaseIndexes.end()) {
+        m_broadPhaseEntries[it.value()].pSprite = nullptr;
+        m_broadPhaseIndexes.erase(it);
+    }
+    m_broadPhasePendingSprites.removeAll(pSprite);
+    m_broadPhaseLateSprites.removeAll(pSprite);
+}
+
+//! Phase large (sweep and prune) : détermine, pour chaque sprite dynamique, les autres
+//! sprites dynamiques susceptibles d'entrer en collision avec lui durant le tick.
+//! Les entrées restent triées d'un tick à l'autre : comme les sprites se déplacent peu
+//! entre deux ticks, le tri par insertion est presque linéaire.
+//! \param elapsedTimeInMilliseconds  Durée du tick.
+void GameScene::updateBroadPhase(long long elapsedTimeInMilliseconds) {
+    // Supprime les entrées des sprites retirés
+    int entryCount = 0;
+    for (int i = 0; i < m_broadPhaseEntries.size(); i++) {
+        if (m_broadPhaseEntries.at(i).pSprite != nullptr)
+            m_broadPhaseEntries[entryCount++] = m_broadPhaseEntries.at(i);
+    }
+    m_broadPhaseEntries.resize(entryCount);
+
+    // Intègre les nouveaux sprites dynamiques
+    for (Sprite* pSprite : std::as_const(m_broadPhasePendingSprites)) {
+        if (!m_broadPhaseIndexes.contains(pSprite)) {
+            m_broadPhaseIndexes.insert(pSprite, static_cast<int>(m_broadPhaseEntries.size()));
+            m_broadPhaseEntries << BroadPhaseEntry { pSprite, QRectF(), false };
+        }
+    }
+    m_broadPhasePendingSprites.clear();
+    m_broadPhaseLateSprites.clear();
+
+    for (BroadPhaseEntry& rEntry : m_broadPhaseEntries) {
+        rEntry.rect = rEntry.pSprite->broadPhaseRect(elapsedTimeInMilliseconds);
+        rEntry.escaped = false;
+    }
+
+    // Tri par insertion selon le bord gauche
+    for (int i = 1; i < m_broadPhaseEntries.size(); i++) {
+        BroadPhaseEntry entry = m_broadPhaseEntries.at(i);
+        int j = i - 1;
+        while (j >= 0 && m_broadPhaseEntries.at(j).rect.left() > entry.rect.left()) {
+            m_broadPhaseEntries[j + 1] = m_broadPhaseEntries.at(j);
+            j--;
+        }
+        m_broadPhaseEntries[j + 1] = entry;
+    }
+
+    const int entryTotal = static_cast<int>(m_broadPhaseEntries.size());
+    m_broadPhaseCandidates.resize(entryTotal);
+    for (int i = 0; i < entryTotal; i++) {
+        m_broadPhaseIndexes[m_broadPhaseEntries.at(i).pSprite] = i;
+        m_broadPhaseCandidates[i].resize(0);
+    }
+
+    // Balayage : seules les entrées qui commencent avant la fin de l'entrée courante peuvent la chevaucher
+    for (int i = 0; i < entryTotal; i++) {
+        const BroadPhaseEntry& rEntry = m_broadPhaseEntries.at(i);
+        for (int j = i + 1; j < entryTotal && m_broadPhaseEntries.at(j).rect.left() <= rEntry.rect.right(); j++) {
+            const BroadPhaseEntry& rOther = m_broadPhaseEntries.at(j);
+            if (rOther.rect.top() <= rEntry.rect.bottom() && rOther.rect.bottom() >= rEntry.rect.top()) {
+                m_broadPhaseCandidates[i] << rOther.pSprite;
+                m_broadPhaseCandidates[j] << rEntry.pSprite;
+            }
+        }
+    }
+
+    m_isBroadPhaseValid = true;
+}
+
 //! Retire de la liste des sprite le sprite qui va être détruit.
 void GameScene::onSpriteDestroyed(Sprite* pSprite) {
-    m_registeredForTickSpriteList.removeAll(pSprite);
+    unregisterSpriteFromTick(pSprite);
+    unregisterSprite(pSprite);
 }
@@ -8,8 +8,15 @@
 #define GAMESCENE_H
 
 #include "gamecanvas.h"
+#include "SpatialGrid.h"
+#include "StaticCollisionTree.h"
+#include "ContactEventQueue.h"
+#include "TimerWheel.h"
+#include "EffectPool.h"
+#include "TickRegistry.h"
 
 #include <QGraphicsScene>
+#include <QHash>
 
 class Sprite;
 class QGraphicsSimpleTextItem;
@@ -27,13 +34,75 @@ class QPainter;
 //! - Détection du sprite à une position donnée avec spriteAt()
 //! - Affichage de textes avec la méthode createText()
 //!
+//! Les sprites ajoutés avec addSpriteToScene() sont mémorisés dans une liste tenue à jour par la scène,
+//! retournée par sprites() sans devoir parcourir tous les éléments graphiques de la scène.
+//!
+//! Les sprites dynamiques sont indexés dans une grille uniforme (SpatialGrid), mise à jour
+//! chaque fois qu'un sprite se déplace. Les sprites statiques (Sprite::setStatic()), qui
+//! forment l'essentiel d'un niveau, sont quant à eux précalculés dans un arbre de collision
+//! immuable (StaticCollisionTree) qui n'est reconstruit que lorsque l'ensemble des sprites
+//! statiques change (voir bakeStaticSprites()). La recherche des sprites en collision avec
+//! un rectangle ne teste ainsi que les sprites proches de ce rectangle, et non tous les sprites de la scène.
+//!
 //! Cette classe ne gère pas la logique du jeu.
 //!
 //! Lorsque la cadence à lieu (tick()), elle se charge d'appeler la fonction Sprite::tick()
 //! pour chaque sprite présent sur cette scène qui s'est au préalable abonné avec la méthode
 //! registerSpriteForTick().
 //!
+//! Un tick est découpé en phases (TickPhase), appelées toujours dans le même ordre : entrées,
+//! avant la physique, physique, après la physique, animation et caméra. Un sprite s'abonne aux
+//! phases dans lesquelles il a quelque chose à faire (par défaut, la phase physique) et est appelé
+//! avec Sprite::phaseTick(). Chaque phase est ainsi exécutée pour tous les sprites avant la suivante :
+//! une plateforme mobile s'est par exemple déjà déplacée lorsque les entités physiques se déplacent,
+//! et la vue ne suit le joueur qu'une fois celui-ci déplacé, quel que soit l'ordre d'abonnement.
+//!
+//! Avant d'appeler les sprites, tick() exécute une phase large (broad phase) de type
+//! *sweep and prune* : le rectangle que chaque sprite dynamique peut couvrir durant le tick
+//! (Sprite::broadPhaseRect()) est trié selon l'axe horizontal, ce qui permet de trouver en une
+//! seule passe les paires de sprites dynamiques proches. Durant le tick, collidingSprites()
+//! appelé avec le sprite qui fait la recherche n'interroge ainsi plus la grille spatiale.
+//! Un sprite qui doit tester plusieurs rectangles (déplacement et sondes) peut les passer
+//! ensemble à collidingSprites() pour ne parcourir les candidats qu'une seule fois.
+//!
+//! Les contacts détectés durant le tick (déclencheurs, collisions, sprites sur lesquels on marche)
+//! sont collectés sans doublons dans une file (ContactEventQueue, voir contactEventQueue()),
+//! qui n'est vidée qu'une fois tous les sprites appelés. Chaque contact n'est ainsi notifié
+//! qu'à son début et à sa fin, et non à chaque tick.
+//!
 //! La méthode unregisterSpriteFromTick() permet de désabonner un sprite à la cadence.
+//! Les sprites abonnés sont tenus dans un TickRegistry : un sprite peut s'abonner ou se désabonner
+//! durant le tick sans que la liste des sprites abonnés ne doive être copiée à chaque tick.
+//!
+//! La scène fait également avancer les animations des sprites (Sprite::startAnimation()) à
+//! chaque tick, selon le temps écoulé, plutôt que de laisser chaque sprite utiliser sa propre
+//! minuterie. Les changements d'images sont ainsi regroupés une fois par tick et suivent le
+//! temps de la simulation.
+//!
+//! Les délais du jeu (réapparition d'un objet, fin d'une ruée...) sont gérés par une roue de
+//! minuteries (TimerWheel, voir timerWheel()) qui avance avec le tick, plutôt que par des QTimer.
+//! Ils suivent ainsi le temps du jeu et s'arrêtent lorsque le jeu est en pause. Les délais d'un sprite
+//! sont annulés lorsqu'il quitte la scène.
+//!
+//! Les effets visuels de courte durée (particules, poussière) sont créés une seule fois puis
+//! réutilisés grâce au réservoir d'effets de la scène (EffectPool, voir effectPool()).
+//!
+//! La scène mémorise la position des sprites abonnés au début et à la fin de chaque tick.
+//! Lorsque la cadence est de durée fixe, GameCanvas appelle interpolate() après les ticks,
+//! qui décale l'affichage des sprites afin de les afficher entre leur position au début du
+//! tick et leur position actuelle. Seuls les
+//! sprites dont le décalage d'affichage change sont redessinés. Un sprite dont le contenu bouge
+//! sans qu'il ne se déplace (Sprite::SelfInterpolatedCapability, par exemple un émetteur de
+//! particules) s'interpole lui-même selon renderProgress() : il est redessiné à chaque appel.
+//!
+//! Pour que le coût d'un tick ne dépende pas de la taille du niveau, seuls les sprites proches de la
+//! partie affichée sont actifs : la région d'activation (activationRegion()) est la partie de la scène
+//! affichée par la vue, agrandie des marges données à setActivationMargins(). Au début de chaque tick,
+//! les sprites abonnés au tick ou animés qui se trouvent hors de cette région sont suspendus : ils ne
+//! reçoivent plus le tick et leur animation n'avance plus. Ils sont réactivés dès que la région les
+//! atteint, en ne parcourant que les sprites qu'elle contient. Un sprite déclaré toujours actif
+//! (Sprite::setAlwaysActive()) n'est jamais suspendu. Sans vue (mode sans affichage), ou si la région
+//! est désactivée avec setActivationRegionEnabled(), tous les sprites restent actifs.
 //!
 //! Les méthodes isInsideScene() permettent de savoir si un sprite ou un rectangle (QRectF) se trouvent complètement à l'intérieur de la scène.
 //!
@@ -56,8 +125,15 @@ public:
 
     QList<Sprite*> collidingSprites(const Sprite* pSprite) const;
     QList<Sprite*> collidingSprites(const QRectF& rRect) const;
+    QList<Sprite*> collidingSprites(const QRectF& rRect, const Sprite* pQuerier) const;
+    QList<QList<Sprite*>> collidingSprites(const QList<QRectF>& rRects, const Sprite* pQuerier = nullptr) const;
+    QList<QList<Sprite*>> collidingSprites(const QRectF& rRect, const QList<QPointF>& rProbeOffsets,
+                                           const Sprite* pQuerier = nullptr) const;
     QList<Sprite*> collidingSprites(const QPainterPath& rShape) const;
     QList<Sprite*> sprites() const;
+    int spriteCount() const { return static_cast<int>(m_spriteList.count()); }
+    bool containsSprite(const Sprite* pSprite) const;
+    void bakeStaticSprites();
     Sprite* spriteAt(const QPointF& rPosition) const;
 
     QGraphicsSimpleTextItem* createText(QPointF initialPosition, const QString& rText, int size = 10, QColor color=Qt::white);
@@ -70,9 +146,11 @@ public:
     void setHeight(int sceneHeight);
     int height() const { return static_cast<int>(sceneRect().height()); }
 
-    void registerSpriteForTick(Sprite* pSprite);
+    void registerSpriteForTick(Sprite* pSprite, TickPhase phase = PhysicsPhase);
     void unregisterSpriteFromTick(Sprite* pSprite);
+    void unregisterSpriteFromTick(Sprite* pSprite, TickPhase phase);
     bool isRegisteredForTick(const Sprite* pSprite) const;
+    bool isRegisteredForTick(const Sprite* pSprite, TickPhase phase) const;
 
     bool isInsideScene(const QPointF& rPosition) const;
     bool isInsideScene(const QRectF& rRect) const;
@@ -80,7 +158,19 @@ public:
     void centerViewOn(const Sprite* pSprite);
     void centerViewOn(QPointF pos);
 
+    void setActivationRegionEnabled(bool enabled);
+    bool isActivationRegionEnabled() const { return m_isActivationRegionEnabled; }
+    void setActivationMargins(qreal horizontalMargin, qreal verticalMargin);
+    QRectF activationRegion() const;
+    bool isSuspended(const Sprite* pSprite) const;
+
     virtual void tick(long long elapsedTimeInMilliseconds);
+    void interpolate(qreal progress);
+    qreal renderProgress() const { return m_renderProgress; }
+
+    ContactEventQueue& contactEventQueue() { return m_contactEventQueue; }
+    TimerWheel& timerWheel() { return m_timerWheel; }
+    EffectPool& effectPool() { return m_effectPool; }
 
 signals:
     void spriteAddedToScene(Sprite* pSprite);
@@ -90,6 +180,9 @@ protected:
     virtual void drawBackground(QPainter* pPainter, const QRectF& rRect) override;
 
 private:
+    // Sprite informe la scène de ses déplacements (updateSpriteGeometry(), updateSpriteMobility()).
+    friend class Sprite;
+
     // Seul GameCanvas est autorisé à instancier un GameScene, afin de garantir que
     // l'instanciation soit faite correctement.
     friend GameScene* GameCanvas::createScene();
@@ -101,9 +194,75 @@ private:
     explicit GameScene(qreal x, qreal y, qreal width, qreal height, QObject* pParent = nullptr);
 
     void init();
+    void updateSpriteGeometry(Sprite* pSprite);
+    void updateSpriteMobility(Sprite* pSprite);
+    void rebuildStaticTree() const;
+    void unregisterSprite(Sprite* pSprite);
+    void registerSpriteForAnimation(Sprite* pSprite);
+    void unregisterSpriteFromAnimation(Sprite* pSprite);
+    void advanceAnimations(long long elapsedTimeInMilliseconds);
+    void updateActivation();
+    void suspendSprite(Sprite* pSprite);
+    void resumeSprite(Sprite* pSprite);
+
+    //! Sprite dynamique de la phase large, avec le rectangle qu'il peut couvrir durant le tick.
+    struct BroadPhaseEntry {
+        Sprite* pSprite;
+        QRectF rect;
+        bool escaped; // Le sprite est sorti de son rectangle durant le tick
+    };
+
+    void addToBroadPhase(Sprite* pSprite);
+    void removeFromBroadPhase(Sprite* pSprite);
+    void updateBroadPhase(long long elapsedTimeInMilliseconds);
+
+    //! État d'affichage d'un sprite abonné au tick, pour l'interpolation de l'affichage.
+    struct SpriteRenderState {
+        Sprite* pSprite;     // Nul si le sprite a quitté la scène ou s'est désabonné du tick
+        QPointF previousPos; // Position au début du tick
+        QPointF currentPos;  // Position à la fin du tick
+    };
+
+    void dispatchTickPhase(TickPhase phase, long long elapsedTimeInMilliseconds);
+    void captureTickStartStates();
+    void captureTickEndStates();
+    QPointF interpolatedOffset(const SpriteRenderState& rState) const;
 
     QImage* m_pBackgroundImage;
-    QList<Sprite*> m_registeredForTickSpriteList;
+    QList<Sprite*> m_spriteList;
+    QHash<const Sprite*, int> m_spriteIndexes;
+    TickRegistry m_tickRegistries[TickPhaseCount]; // Sprites abonnés à chaque phase du tick
+    QList<Sprite*> m_animatedSpriteList;               // Sprites dont l'animation est en cours
+    QHash<const Sprite*, int> m_animatedSpriteIndexes; // Indice de chaque sprite animé
+    SpatialGrid m_spatialGrid;
+    QHash<Sprite*, QRectF> m_staticSprites;
+    mutable StaticCollisionTree m_staticTree;
+    mutable bool m_staticTreeDirty;
+
+    QList<BroadPhaseEntry> m_broadPhaseEntries;      // Triés selon le bord gauche de leur rectangle
+    QList<QList<Sprite*>> m_broadPhaseCandidates;    // Sprites dynamiques proches de chaque entrée
+    QHash<const Sprite*, int> m_broadPhaseIndexes;   // Indice de l'entrée de chaque sprite
+    QList<Sprite*> m_broadPhasePendingSprites;       // Sprites dynamiques à intégrer à la prochaine phase large
+    QList<Sprite*> m_broadPhaseLateSprites;          // Sprites non couverts par la phase large du tick en cours
+    bool m_isBroadPhaseValid;
+
+    ContactEventQueue m_contactEventQueue;
+
+    static constexpr qreal DEFAULT_ACTIVATION_MARGIN = 512; // Marge par défaut autour de la partie affichée
+    static constexpr qreal ACTIVATION_HYSTERESIS = 64;      // Distance supplémentaire avant de suspendre un sprite
+    static constexpr int ANIMATION_SUSPENDED = 1 << TickPhaseCount; // Le sprite suspendu était animé
+
+    bool m_isActivationRegionEnabled;
+    qreal m_horizontalActivationMargin;
+    qreal m_verticalActivationMargin;
+    QHash<Sprite*, int> m_suspendedSprites; // Phases du tick (bit 1 << phase) et animation de chaque sprite suspendu
+    TimerWheel m_timerWheel;
+    EffectPool m_effectPool;
+
+    const Sprite* m_pCenteredSprite; // Sprite suivi par la vue, pour l'interpolation de l'affichage
+
+    QList<SpriteRenderState> m_renderStates; // Positions des sprites abonnés au début et à la fin du dernier tick
+    qreal m_renderProgress;                  // Avancement de l'affichage depuis le dernier tick
 
 private slots:
     void onSpriteDestroyed(Sprite* pSprite);
@@ -147,6 +147,12 @@
  * Pour cela, ajouter dans MainFrm::MainFrm() la ligne de code `ui->grvGame->setFitToScreenEnabled(true);`.
  * - Supprimer les marges de l'affichage de la surface de jeu. Pour cela, ajouter dans MainFrm::MainFrm() la ligne de code `ui->verticalLayout->setContentsMargins(QMargins(0,0,0,0));`.
  *
+ * \section headless_mode Le mode sans affichage
+ * La cible `2023-JCO-Airtime-headless` (main_headless.cpp) fait fonctionner GameCore et sa scène sans fenêtre,
+ * avec un GameCanvas construit sans vue. Le jeu avance alors par appels à GameCanvas::step(), aussi vite que le
+ * processeur le permet, ce qui permet de mesurer les performances ou d'automatiser des parties sur un serveur sans écran.
+ * La durée de jeu à simuler est donnée avec l'option `--duration` (en secondes).
+ *
  * \section utilities Les fonctions utilitaires
  * En plus des fonctions utilitaires liées aux resources (\ref res_sec), le fichier utilities.h met à disposition des fonctions
  * utiliaires diverses, en particulier des fonctions permettant de connaître les dimensions de l'écran et le rapport largeur/hauteur.
@@ -0,0 +1,335 @@
+/**
+  \file
+  \brief    Point d'entrée du jeu sans affichage.
+  \author   Blattner Noah
+  \date     juin 2023
+
+  Fait avancer GameCore et sa scène depuis une simple boucle, sans fenêtre ni GameView,
+  aussi vite que le processeur le permet. Utile pour mesurer les performances de la
+  physique et des niveaux, ou pour des parties automatisées sur un serveur sans écran.
+
+  Avec l'option --particle-benchmark, mesure plutôt le nombre de particules qu'un
+  ParticleEmitter fait avancer par milliseconde, pour chaque jeu d'instructions
+  supporté par les noyaux vectorisés (ParticleKernels).
+
+  Avec l'option --tick-benchmark, mesure le coût moyen d'un tick de GameScene selon
+  le nombre d'entités physiques de la scène.
+
+  Avec l'option --collision-benchmark, mesure le coût moyen d'une requête de collision,
+  ainsi que celui du classement de ses candidats par dynamic_cast et par capacités.
+*/
+
+#include "gamecanvas.h"
+#include "gamescene.h"
+#include "FastRandom.h"
+#include "ParticleEmitter.h"
+#include "ParticleKernels.h"
+#include "PhysicsEntity.h"
+#include "resources.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QElapsedTimer>
+
+const int DEFAULT_SIMULATED_DURATION = 60; // Secondes de jeu simulées par défaut
+const int PARTICLE_BENCHMARK_TICK_COUNT = 500; // Ticks mesurés par jeu d'instructions
+const int PARTICLE_BENCHMARK_STEP_DURATION = 20; // Durée d'un tick mesuré (50 ticks par seconde), en millisecondes
+const quint64 PARTICLE_BENCHMARK_SEED = 2023; // Graine des émetteurs mesurés, pour des mesures reproductibles
+const int TICK_BENCHMARK_TICK_COUNT = 250; // Ticks mesurés par nombre d'entités
+const int TICK_BENCHMARK_SIZE_COUNT = 4; // Nombres d'entités mesurés : le nombre demandé et ses moitiés successives
+const int COLLISION_BENCHMARK_QUERY_COUNT = 100000; // Requêtes mesurées
+const qreal COLLISION_BENCHMARK_QUERY_MARGIN = 8; // Marge autour d'une entité interrogée, comme pour un déplacement
+const quint64 BENCHMARK_SEED = 2023; // Graine du placement des entités, pour des mesures reproductibles
+const int BENCHMARK_SCENE_WIDTH_PER_ENTITY = 64; // Largeur de scène par entité : la densité ne dépend pas du nombre d'entités
+const int BENCHMARK_SCENE_HEIGHT = 480;
+const qreal BENCHMARK_ENTITY_SCALE = 0.25;
+const float BENCHMARK_MAX_ENTITY_SPEED = 0.2f; // En pixels par milliseconde
+
+//! Entité physique des mesures, qui ne s'endort jamais : chaque tick mesuré la fait avancer
+//! et interroge la scène, comme une entité en mouvement.
+class BenchmarkEntity : public PhysicsEntity {
+public:
+    explicit BenchmarkEntity(const QString& rImagePath) : PhysicsEntity(rImagePath) {}
+
+protected:
+    bool isAtRest() const override { return false; }
+};
+
+//! Remplit une scène de mesure : un sol statique sur toute sa largeur et des entités physiques
+//! placées au hasard au-dessus, avec une vitesse horizontale aléatoire.
+//! \param pScene       Scène à remplir.
+//! \param entityCount  Nombre d'entités physiques.
+//! \param rRandom      Générateur des positions et des vitesses.
+static void populateBenchmarkScene(GameScene* pScene, int entityCount, FastRandom& rRandom) {
+    const QString floorImagePath = GameFramework::imagesPath() + "plateform.png";
+    int floorTop = BENCHMARK_SCENE_HEIGHT;
+    for (int floorX = 0; floorX < pScene->width(); ) {
+        auto* pFloor = new AdvancedCollisionSprite(floorImagePath);
+        pFloor->setStatic(true);
+        floorTop = BENCHMARK_SCENE_HEIGHT - pFloor->height();
+        pScene->addSpriteToScene(pFloor, floorX, floorTop);
+        floorX += pFloor->width();
+    }
+    pScene->bakeStaticSprites();
+
+    const QString entityImagePath = GameFramework::imagesPath() + "dumpster.png";
+    for (int i = 0; i < entityCount; i++) {
+        auto* pEntity = new BenchmarkEntity(entityImagePath);
+        pEntity->setScale(BENCHMARK_ENTITY_SCALE);
+        pScene->addSpriteToScene(pEntity,
+                                 rRandom.bounded(static_cast<float>(pScene->width() - pEntity->width())),
+                                 rRandom.bounded(static_cast<float>(floorTop - pEntity->height())));
+        pEntity->setXVelocity(rRandom.bounded(2 * BENCHMARK_MAX_ENTITY_SPEED) - BENCHMARK_MAX_ENTITY_SPEED);
+    }
+}
+
+//! Mesure le coût moyen d'un tick de GameScene pour un nombre croissant d'entités physiques,
+//! et l'affiche. La largeur de la scène grandit avec le nombre d'entités : avec un index spatial,
+//! le coût d'un tick doit augmenter proportionnellement au nombre d'entités, et non plus vite.
+//! \param rCanvas      Canvas qui crée les scènes mesurées.
+//! \param entityCount  Nombre d'entités de la plus grande scène.
+//! \param stepDuration Durée d'un tick, en millisecondes.
+static void runTickBenchmark(GameCanvas& rCanvas, int entityCount, int stepDuration) {
+    int sceneEntityCount = entityCount >> (TICK_BENCHMARK_SIZE_COUNT - 1);
+    for (int size = 0; size < TICK_BENCHMARK_SIZE_COUNT; size++, sceneEntityCount *= 2) {
+        if (sceneEntityCount <= 0)
+            continue;
+        if (size == TICK_BENCHMARK_SIZE_COUNT - 1)
+            sceneEntityCount = entityCount;
+
+        FastRandom random(BENCHMARK_SEED);
+        GameScene* pScene = rCanvas.createScene(0, 0, sceneEntityCount * BENCHMARK_SCENE_WIDTH_PER_ENTITY,
+                                                BENCHMARK_SCENE_HEIGHT);
+        populateBenchmarkScene(pScene, sceneEntityCount, random);
+
+        QElapsedTimer benchmarkTimer;
+        benchmarkTimer.start();
+        for (int tick = 0; tick < TICK_BENCHMARK_TICK_COUNT; tick++)
+            pScene->tick(stepDuration);
+        qint64 benchmarkDurationNs = benchmarkTimer.nsecsElapsed();
+
+        qInfo() << "Entités :" << sceneEntityCount
+                << ". Sprites :" << pScene->spriteCount()
+                << ". Coût moyen d'un tick (us) :" << benchmarkDurationNs / 1000 / TICK_BENCHMARK_TICK_COUNT;
+
+        delete pScene;
+    }
+}
+
+//! Mesure le débit d'un ParticleEmitter, en particules par milliseconde, pour chaque
+//! jeu d'instructions supporté, et l'affiche.
+//! \param particleCount  Nombre de particules de l'émetteur.
+//! \param stepDuration   Durée d'un tick, en millisecondes.
+static void runParticleBenchmark(int particleCount, int stepDuration) {
+    for (int instructionSet = ParticleKernels::SCALAR; instructionSet <= ParticleKernels::bestInstructionSet(); instructionSet++) {
+        ParticleKernels::setInstructionSet(static_cast<ParticleKernels::InstructionSet>(instructionSet));
+
+        // Un mélange des types qui s'estompent, qui survivent à toute la mesure
+        // Même graine pour chaque jeu d'instructions : les particules simulées sont identiques
+        ParticleEmitter emitter(GameFramework::imagesPath() + "particle.png");
+        emitter.setRandomSeed(PARTICLE_BENCHMARK_SEED);
+        emitter.fadeTime = 3600;
+        emitter.acceleration = 0.5f;
+        emitter.spawnParticles(ParticleEmitter::EXPLOSIVE, QPointF(0, 0), particleCount / 3);
+        emitter.spawnParticles(ParticleEmitter::SMOKE, QPointF(0, 0), particleCount / 3);
+        emitter.spawnParticles(ParticleEmitter::DUST, QPointF(0, 0), particleCount - 2 * (particleCount / 3));
+
+        QElapsedTimer benchmarkTimer;
+        benchmarkTimer.start();
+        for (int tick = 0; tick < PARTICLE_BENCHMARK_TICK_COUNT; tick++)
+            emitter.tick(stepDuration);
+        qint64 benchmarkDurationNs = benchmarkTimer.nsecsElapsed();
+
+        double particlesPerMs = static_cast<double>(particleCount) * PARTICLE_BENCHMARK_TICK_COUNT
+                                / (static_cast<double>(benchmarkDurationNs) / 1000000.0);
+        qInfo() << "Particules (" << ParticleKernels::instructionSetName(ParticleKernels::instructionSet())
+                << ") :" << particleCount << ". Particules par ms :" << qRound64(particlesPerMs);
+    }
+
+    ParticleKernels::setInstructionSet(ParticleKernels::bestInstructionSet());
+}
+
+//! Mesure le coût moyen d'une requête de collision (recherche des candidats dans la scène,
+//! puis filtrage) et l'affiche. Mesure également le coût du seul classement des candidats,
+//! avec dynamic_cast comme auparavant, puis avec les capacités des sprites (Sprite::hasCapability()).
+//! \param rCanvas      Canvas qui crée la scène mesurée.
+//! \param entityCount  Nombre d'entités de la scène.
+static void runCollisionBenchmark(GameCanvas& rCanvas, int entityCount) {
+    FastRandom random(BENCHMARK_SEED);
+    GameScene* pScene = rCanvas.createScene(0, 0, entityCount * BENCHMARK_SCENE_WIDTH_PER_ENTITY,
+                                            BENCHMARK_SCENE_HEIGHT);
+    populateBenchmarkScene(pScene, entityCount, random);
+
+    QList<AdvancedCollisionSprite*> entities;
+    for (Sprite* pSprite : pScene->sprites()) {
+        if (pSprite->hasCapability(Sprite::PhysicsCapability))
+            entities << static_cast<AdvancedCollisionSprite*>(pSprite);
+    }
+
+    // Chaque requête est faite par une entité tirée au hasard, autour de sa position
+    QList<AdvancedCollisionSprite*> queriers;
+    QList<QRectF> queryRects;
+    queriers.reserve(COLLISION_BENCHMARK_QUERY_COUNT);
+    queryRects.reserve(COLLISION_BENCHMARK_QUERY_COUNT);
+    for (int query = 0; query < COLLISION_BENCHMARK_QUERY_COUNT; query++) {
+        AdvancedCollisionSprite* pQuerier = entities.at(static_cast<int>(random.generate() % entities.size()));
+        queriers << pQuerier;
+        queryRects << pQuerier->collisionRect().adjusted(-COLLISION_BENCHMARK_QUERY_MARGIN, -COLLISION_BENCHMARK_QUERY_MARGIN,
+                                                          COLLISION_BENCHMARK_QUERY_MARGIN, COLLISION_BENCHMARK_QUERY_MARGIN);
+    }
+
+    QElapsedTimer benchmarkTimer;
+    benchmarkTimer.start();
+    qint64 collidingCount = 0;
+    for (int query = 0; query < COLLISION_BENCHMARK_QUERY_COUNT; query++)
+        collidingCount += queriers.at(query)->getCollidingSprites(queryRects.at(query)).size();
+    qint64 queryDurationNs = benchmarkTimer.nsecsElapsed();
+
+    // Classement seul des mêmes candidats, pour comparer dynamic_cast et les capacités
+    QList<QList<Sprite*>> candidateLists;
+    candidateLists.reserve(COLLISION_BENCHMARK_QUERY_COUNT);
+    qint64 candidateCount = 0;
+    for (const QRectF& rQueryRect : std::as_const(queryRects)) {
+        candidateLists << pScene->collidingSprites(rQueryRect);
+        candidateCount += candidateLists.last().size();
+    }
+
+    benchmarkTimer.start();
+    qint64 dynamicCastCount = 0;
+    for (const QList<Sprite*>& rCandidates : std::as_const(candidateLists)) {
+        for (Sprite* pSprite : rCandidates) {
+            if (dynamic_cast<AdvancedCollisionSprite*>(pSprite) != nullptr)
+                dynamicCastCount++;
+        }
+    }
+    qint64 dynamicCastDurationNs = benchmarkTimer.nsecsElapsed();
+
+    benchmarkTimer.start();
+    qint64 capabilityCount = 0;
+    for (const QList<Sprite*>& rCandidates : std::as_const(candidateLists)) {
+        for (Sprite* pSprite : rCandidates) {
+            if (AdvancedCollisionSprite::fromSprite(pSprite) != nullptr)
+                capabilityCount++;
+        }
+    }
+    qint64 capabilityDurationNs = benchmarkTimer.nsecsElapsed();
+
+    if (dynamicCastCount != capabilityCount)
+        qWarning() << "Les deux classements ne trouvent pas les mêmes sprites :" << dynamicCastCount << capabilityCount;
+
+    qInfo() << "Entités :" << entityCount
+            << ". Candidats par requête :" << static_cast<double>(candidateCount) / COLLISION_BENCHMARK_QUERY_COUNT
+            << ". Collisions par requête :" << static_cast<double>(collidingCount) / COLLISION_BENCHMARK_QUERY_COUNT
+            << ". Coût moyen d'une requête (ns) :" << queryDurationNs / COLLISION_BENCHMARK_QUERY_COUNT;
+    qInfo() << "Classement des candidats, coût moyen par requête (ns) : dynamic_cast :"
+            << dynamicCastDurationNs / COLLISION_BENCHMARK_QUERY_COUNT
+            << ". Capacités :" << capabilityDurationNs / COLLISION_BENCHMARK_QUERY_COUNT;
+
+    delete pScene;
+}
+
+/**
+ * @brief main
+ * @param argc
+ * @param argv
+ * @return
+ */
+int main(int argc, char *argv[])
+{
+    // Sans serveur d'affichage, Qt utilise une plateforme qui n'affiche rien
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Simulation de 2023-JCO-Airtime sans affichage.");
+    parser.addHelpOption();
+    QCommandLineOption durationOption(QStringList() << "d" << "duration",
+                                      "Durée de jeu à simuler, en secondes.", "secondes",
+                                      QString::number(DEFAULT_SIMULATED_DURATION));
+    parser.addOption(durationOption);
+    QCommandLineOption particleBenchmarkOption("particle-benchmark",
+                                               "Mesure le débit des particules au lieu de simuler le jeu.", "particules");
+    parser.addOption(particleBenchmarkOption);
+    QCommandLineOption tickBenchmarkOption("tick-benchmark",
+                                           "Mesure le coût d'un tick selon le nombre d'entités au lieu de simuler le jeu.", "entités");
+    parser.addOption(tickBenchmarkOption);
+    QCommandLineOption collisionBenchmarkOption("collision-benchmark",
+                                                "Mesure le coût d'une requête de collision au lieu de simuler le jeu.", "entités");
+    parser.addOption(collisionBenchmarkOption);
+    parser.process(a);
+
+    if (parser.isSet(particleBenchmarkOption)) {
+        bool isParticleCountValid = false;
+        int particleCount = parser.value(particleBenchmarkOption).toInt(&isParticleCountValid);
+        if (!isParticleCountValid || particleCount <= 0) {
+            qCritical() << "Nombre de particules invalide :" << parser.value(particleBenchmarkOption);
+            return -1;
+        }
+
+        runParticleBenchmark(particleCount, PARTICLE_BENCHMARK_STEP_DURATION);
+        return 0;
+    }
+
+    if (parser.isSet(tickBenchmarkOption)) {
+        bool isEntityCountValid = false;
+        int entityCount = parser.value(tickBenchmarkOption).toInt(&isEntityCountValid);
+        if (!isEntityCountValid || entityCount <= 0) {
+            qCritical() << "Nombre d'entités invalide :" << parser.value(tickBenchmarkOption);
+            return -1;
+        }
+
+        GameCanvas canvas(nullptr);
+        runTickBenchmark(canvas, entityCount, canvas.fixedStepDuration());
+        return 0;
+    }
+
+    if (parser.isSet(collisionBenchmarkOption)) {
+        bool isEntityCountValid = false;
+        int entityCount = parser.value(collisionBenchmarkOption).toInt(&isEntityCountValid);
+        if (!isEntityCountValid || entityCount <= 0) {
+            qCritical() << "Nombre d'entités invalide :" << parser.value(collisionBenchmarkOption);
+            return -1;
+        }
+
+        GameCanvas canvas(nullptr);
+        runCollisionBenchmark(canvas, entityCount);
+        return 0;
+    }
+
+    bool isDurationValid = false;
+    int simulatedDuration = parser.value(durationOption).toInt(&isDurationValid);
+    if (!isDurationValid || simulatedDuration <= 0) {
+        qCritical() << "Durée invalide :" << parser.value(durationOption);
+        return -1;
+    }
+
+    // Sans vue, GameCore est créé immédiatement et le jeu n'avance qu'avec step()
+    GameCanvas canvas(nullptr);
+
+    const int stepDuration = canvas.fixedStepDuration();
+    const long long stepCount = simulatedDuration * 1000LL / stepDuration;
+
+    QElapsedTimer simulationTimer;
+    simulationTimer.start();
+
+    long long step = 0;
+    while (step < stepCount && canvas.isTicking()) {
+        canvas.step(stepDuration);
+        step++;
+
+        // Traite les destructions différées (deleteLater()) et les signaux en attente
+        QCoreApplication::processEvents();
+    }
+
+    qint64 simulationDurationNs = simulationTimer.nsecsElapsed();
+    qInfo() << "Ticks :" << step
+            << ". Temps simulé (ms) :" << step * stepDuration
+            << ". Durée réelle (ms) :" << simulationDurationNs / 1000000
+            << ". Coût moyen d'un tick (us) :" << (step > 0 ? simulationDurationNs / 1000 / step : 0)
+            << ". Sprites :" << (canvas.currentScene() ? canvas.currentScene()->spriteCount() : 0);
+
+    return 0;
+}
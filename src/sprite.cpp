@@ -8,6 +8,7 @@
 
 #include <QDebug>
 #include <QPainter>
+#include <utility>
 
 #include "gamescene.h"
 #include "spritetickhandler.h"
@@ -74,7 +75,9 @@ void Sprite::setCurrentAnimationFrame(int frameIndex) {
         frameIndex = 0;
 
     m_currentAnimationFrame = frameIndex;
+    m_animationElapsedTime = 0;
     setPixmap(m_animationList[m_currentAnimationIndex][frameIndex]);
+    notifyGeometryChanged();
     setAnimationSpeed(m_animationDurationList[m_currentAnimationIndex][frameIndex]);
 }
 
@@ -90,6 +93,7 @@ void Sprite::clearAnimationFrames() {
     m_animationDurationList[m_currentAnimationIndex].clear();
     m_currentAnimationFrame = NO_CURRENT_FRAME;
     setPixmap(QPixmap()); // On enlève l'image du sprite afin d'éviter toute confusion.
+    notifyGeometryChanged();
 }
 
 //! Affiche l'image suivante.
@@ -101,11 +105,9 @@ void Sprite::showNextAnimationFrame() {
 //! \param frameDuration   Durée d'une image en millisecondes.
 void Sprite::setAnimationSpeed(int frameDuration) {
     if (frameDuration <= 0)
-        m_animationTimer.stop();
-    else if (frameDuration != m_frameDuration) {
+        setAnimationRunning(false);
+    else
         m_frameDuration = frameDuration;
-        m_animationTimer.setInterval(frameDuration);
-    }
 }
 
 //! Arrête l'animation.
@@ -118,7 +120,7 @@ void Sprite::stopAnimation(AnimationStopMode stopMode) {
         return;
 
     if (stopMode == IMMEDIATE_STOP)
-        m_animationTimer.stop();
+        setAnimationRunning(false);
     else if (stopMode == END_OF_CYCLE_STOP)
         m_animationStopLater = true;
 }
@@ -128,8 +130,9 @@ void Sprite::stopAnimation(AnimationStopMode stopMode) {
 //! spécifiée avec setAnimationSpeed().
 void Sprite::startAnimation() {
     m_currentAnimationFrame = NO_CURRENT_FRAME;
+    m_animationElapsedTime = 0;
     onNextAnimationFrame();
-    m_animationTimer.start();
+    setAnimationRunning(true);
 }
 
 //! Démarre l'animation à la vitesse donnée.
@@ -142,7 +145,55 @@ void Sprite::startAnimation(int frameDuration)  {
 
 //! \return un booléen qui indique si l'animation est en cours.
 bool Sprite::isAnimationRunning() const {
-    return m_animationTimer.isActive();
+    return m_isAnimationRunning;
+}
+
+//! Fait avancer l'animation du temps donné.
+//! Appelé par la scène à chaque tick, tant que l'animation est en cours.
+//! Le temps est accumulé : autant d'images que nécessaire sont passées pour rattraper
+//! le temps écoulé, mais au plus un cycle complet, afin qu'un tick exceptionnellement
+//! long ne bloque pas le jeu.
+//! \param elapsedTimeInMilliseconds  Temps écoulé depuis l'appel précédent.
+void Sprite::advanceAnimation(long long elapsedTimeInMilliseconds) {
+    if (!m_isAnimationRunning || m_frameDuration <= 0)
+        return;
+
+    m_animationElapsedTime += elapsedTimeInMilliseconds;
+
+    int remainingFrames = static_cast<int>(m_animationList[m_currentAnimationIndex].count());
+    while (m_isAnimationRunning && m_animationElapsedTime >= m_frameDuration) {
+        if (remainingFrames-- <= 0) {
+            // Le retard est abandonné
+            m_animationElapsedTime = 0;
+            return;
+        }
+        m_animationElapsedTime -= m_frameDuration;
+        onNextAnimationFrame();
+    }
+}
+
+//! Exécute la fonction donnée après le délai donné, compté en temps de jeu.
+//! Le délai est confié à la roue de minuteries de la scène (GameScene::timerWheel()) : il n'avance
+//! qu'avec le tick et est annulé si le sprite quitte la scène.
+//! Si le sprite n'est sur aucune scène, le délai est confié à un QTimer et ne peut pas être annulé.
+//! \param delayInMilliseconds  Délai en millisecondes.
+//! \param callback             Fonction à exécuter.
+//! \return l'identifiant du délai, à donner à cancelScheduled(), ou TimerWheel::INVALID_TIMER.
+TimerWheel::TimerId Sprite::scheduleAfter(int delayInMilliseconds, TimerWheel::Callback callback) {
+    if (m_pParentScene == nullptr) {
+        QTimer::singleShot(delayInMilliseconds, this, std::move(callback));
+        return TimerWheel::INVALID_TIMER;
+    }
+
+    return m_pParentScene->timerWheel().schedule(delayInMilliseconds, std::move(callback), this);
+}
+
+//! Annule un délai démarré avec scheduleAfter().
+//! Sans effet si le délai est déjà échu ou annulé.
+//! \param timerId  Identifiant du délai.
+void Sprite::cancelScheduled(TimerWheel::TimerId timerId) {
+    if (m_pParentScene != nullptr && timerId != TimerWheel::INVALID_TIMER)
+        m_pParentScene->timerWheel().cancel(timerId);
 }
 
 //! Ajoute une animation supplémentaire à ce sprite.
@@ -202,7 +253,8 @@ void Sprite::showFrameFor(const QPixmap& pixmap, int duration) {
     showingFrame = true;
     stopAnimation();
     setPixmap(pixmap);
-    QTimer::singleShot(duration, this, SLOT(endShowFrame()));
+    notifyGeometryChanged();
+    scheduleAfter(duration, [this]() { endShowFrame(); });
 }
 
 //! Called by showFrameFor() after the duration has elapsed.
@@ -228,14 +280,126 @@ bool Sprite::isEmitSignalEndOfAnimationEnabled() const {
 //! Mémorise la scène à laquelle appartient ce sprite.
 //! \param pScene  Scène à laquelle appartient ce sprite.
 void Sprite::setParentScene(GameScene* pScene) {
+    if (m_isAnimationRunning && m_pParentScene != nullptr && m_pParentScene != pScene)
+        m_pParentScene->unregisterSpriteFromAnimation(this);
+
     m_pParentScene = pScene;
+
+    // Une animation démarrée avant l'ajout à la scène avance dès maintenant
+    if (m_isAnimationRunning && m_pParentScene != nullptr)
+        m_pParentScene->registerSpriteForAnimation(this);
+}
+
+//! Rectangle dans lequel le sprite est dessiné, dans son propre système de coordonnées.
+//! Lorsque le sprite est affiché décalé (renderOffset()), le rectangle couvre à la fois sa
+//! position simulée et sa position affichée : la scène redessine et indexe ainsi toute la
+//! zone dans laquelle le sprite peut être dessiné.
+//! \return le rectangle dans lequel le sprite est dessiné.
+QRectF Sprite::boundingRect() const {
+    QRectF rect = localBoundingRect();
+    if (!m_renderOffset.isNull())
+        rect |= rect.translated(localRenderOffset());
+    return rect;
+}
+
+//! Rectangle occupé par le sprite à sa position simulée, dans son propre système de coordonnées.
+//! Contrairement à boundingRect(), il ne tient pas compte du décalage de l'affichage : c'est
+//! sur ce rectangle que se basent les collisions (voir globalBoundingRect()).
+//! Les sous-classes dont l'apparence ne se limite pas à l'image du sprite redéfinissent cette méthode.
+//! \return le rectangle occupé par le sprite.
+QRectF Sprite::localBoundingRect() const {
+    return QGraphicsPixmapItem::boundingRect();
+}
+
+//! Rectangle dans lequel le sprite est inscrit, en coordonnées de la scène.
+//! Le rectangle est mémorisé et n'est recalculé que si la position ou les transformations
+//! du sprite ou de l'un de ses parents ont changé (itemChange(), setTransformations()),
+//! ou si son image a changé de taille.
+//! \return le rectangle dans lequel le sprite est inscrit.
+QRectF Sprite::globalBoundingRect() const {
+    QRectF localRect = localBoundingRect();
+    if (!m_isGlobalBoundingRectValid || localRect != m_cachedBoundingRect) {
+        m_cachedBoundingRect = localRect;
+        m_globalBoundingRect = mapRectToScene(localRect);
+        m_isGlobalBoundingRectValid = true;
+    }
+    return m_globalBoundingRect;
+}
+
+//! Rectangle (en coordonnées de la scène) que le sprite est susceptible de couvrir
+//! durant le prochain tick. Utilisé par la scène pour déterminer, une fois par tick,
+//! quels sprites dynamiques sont proches les uns des autres (GameScene::tick()).
+//! Par défaut, un sprite ne se déplace pas de lui-même : le rectangle est son globalBoundingRect().
+//! \param elapsedTimeInMilliseconds  Durée du prochain tick.
+//! \return le rectangle couvert par le sprite durant le prochain tick.
+QRectF Sprite::broadPhaseRect(long long elapsedTimeInMilliseconds) const {
+    Q_UNUSED(elapsedTimeInMilliseconds);
+    return globalBoundingRect();
+}
+
+//! Indique si ce sprite est statique, c'est-à-dire s'il ne se déplace jamais.
+//! Les sprites statiques sont rangés par la scène dans une structure de collision
+//! précalculée, plutôt que dans la grille mise à jour à chaque déplacement.
+//! Il est préférable de définir cette propriété avant d'ajouter le sprite à la scène.
+//! \param isStatic  Indique si le sprite est statique (true) ou non (false).
+void Sprite::setStatic(bool isStatic) {
+    if (m_isStatic == isStatic)
+        return;
+
+    m_isStatic = isStatic;
+    if (m_pParentScene != nullptr)
+        m_pParentScene->updateSpriteMobility(this);
 }
 
-#ifdef QT_DEBUG
-//! Dessine le sprite, avec sa boundingbox qui l'entoure.
+//! Indique si ce sprite doit rester actif même loin de la partie affichée de la scène.
+//! Un tel sprite n'est jamais suspendu par la région d'activation (voir GameScene::activationRegion()).
+//! \param isAlwaysActive  Indique si le sprite est toujours actif (true) ou non (false).
+void Sprite::setAlwaysActive(bool isAlwaysActive) {
+    m_isAlwaysActive = isAlwaysActive;
+    if (isAlwaysActive && m_pParentScene != nullptr)
+        m_pParentScene->resumeSprite(this);
+}
+
+//! Applique une liste de transformations au sprite (voir QGraphicsItem::setTransformations()).
+//! Contrairement aux autres transformations, QGraphicsItem n'en informe pas itemChange() :
+//! le rectangle global mémorisé est donc invalidé ici. Si l'une des transformations est
+//! modifiée par la suite, il faut à nouveau appeler cette méthode.
+//! \param rTransformations  Liste des transformations.
+void Sprite::setTransformations(const QList<QGraphicsTransform*>& rTransformations) {
+    QGraphicsPixmapItem::setTransformations(rTransformations);
+    notifyGeometryChanged();
+}
+
+//! Détermine le décalage de l'affichage du sprite par rapport à sa position simulée.
+//! Le rectangle de dessin du sprite (boundingRect()) change avec le décalage : la scène
+//! en est informée et redessine l'ancienne et la nouvelle zone du sprite.
+//! \param rOffset  Décalage, en coordonnées de la scène.
+void Sprite::setRenderOffset(const QPointF& rOffset) {
+    if (rOffset == m_renderOffset)
+        return;
+
+    prepareGeometryChange();
+    m_renderOffset = rOffset;
+}
+
+//! \return le décalage de l'affichage, dans le système de coordonnées du sprite.
+QPointF Sprite::localRenderOffset() const {
+    // Le décalage est exprimé dans le système de coordonnées de la scène
+    return mapFromScene(m_renderOffset) - mapFromScene(QPointF(0, 0));
+}
+
+//! Dessine le sprite, décalé de renderOffset() (voir GameScene::interpolate()).
+//! En mode debug, dessine également sa boundingbox qui l'entoure.
 void Sprite::paint(QPainter* pPainter, const QStyleOptionGraphicsItem* pOption, QWidget* pWidget) {
+    const bool isRenderOffset = !m_renderOffset.isNull();
+    if (isRenderOffset) {
+        pPainter->save();
+        pPainter->translate(localRenderOffset());
+    }
+
     QGraphicsPixmapItem::paint(pPainter, pOption, pWidget);
 
+#ifdef QT_DEBUG
 #ifdef DEBUG_BRECT
     pPainter->setPen(Qt::cyan);
     pPainter->drawRect(this->boundingRect());
@@ -274,22 +438,33 @@ void Sprite::paint(QPainter* pPainter, const QStyleOptionGraphicsItem* pOption,
         // Rétablissement de la mise à l'échelle
         pPainter->restore();
     }
-}
 #endif
 
+    if (isRenderOffset)
+        pPainter->restore();
+}
+
 //! Enregistre ce sprite auprès de la scène afin qu'il soit informé de la
 //! cadence et que la fonction tick() soit appelée en cadence.
-void Sprite::registerForTick() {
+//! \param phase  Phase du tick durant laquelle ce sprite est appelé (par défaut, la phase physique).
+void Sprite::registerForTick(TickPhase phase) {
     Q_ASSERT(m_pParentScene != nullptr);
-    m_pParentScene->registerSpriteForTick(this);
+    m_pParentScene->registerSpriteForTick(this, phase);
 }
 
-//! Désolidarise ce sprite de la cadence.
+//! Désolidarise ce sprite de la cadence, pour toutes les phases.
 void Sprite::unregisterFromTick() {
     Q_ASSERT(m_pParentScene != nullptr);
     m_pParentScene->unregisterSpriteFromTick(this);
 }
 
+//! Désolidarise ce sprite de la phase donnée de la cadence.
+//! \param phase  Phase du tick.
+void Sprite::unregisterFromTick(TickPhase phase) {
+    Q_ASSERT(m_pParentScene != nullptr);
+    m_pParentScene->unregisterSpriteFromTick(this, phase);
+}
+
 //! Cadence.
 //! Pour qu'un sprite soit cadencé, il doit s'enregister avec la méthode
 //! registerForTick().
@@ -300,6 +475,17 @@ void Sprite::tick(long long elapsedTimeInMilliseconds) {
         m_pTickHandler->tick(elapsedTimeInMilliseconds);
 }
 
+//! Phase de la cadence.
+//! Appelé par la scène pour chaque phase du tick à laquelle ce sprite est abonné.
+//! Par défaut, appelle tick() : un sprite abonné à plusieurs phases doit surcharger
+//! cette méthode.
+//! \param phase                      Phase du tick en cours.
+//! \param elapsedTimeInMilliseconds  Temps écoulé depuis le tick précédent.
+void Sprite::phaseTick(TickPhase phase, long long elapsedTimeInMilliseconds) {
+    Q_UNUSED(phase);
+    tick(elapsedTimeInMilliseconds);
+}
+
 //! Attribue à ce sprite un gestionnaire de tick.
 //! L'ancien gestionnaire est détruit.
 //! Ce sprite prend la propriété du gestionnaire.
@@ -394,20 +580,80 @@ QList<Sprite*> Sprite::collidingSprites(const QPainterPath& rShape) const {
     return collidingSpriteList;
 }
 
+//! Intercepte les changements de géométrie du sprite (position et transformations),
+//! ainsi que les déplacements de ses parents, afin d'en informer la scène.
+//! \param change  Type de changement.
+//! \param rValue  Valeur associée au changement.
+//! \return la valeur retournée par QGraphicsPixmapItem::itemChange().
+QVariant Sprite::itemChange(GraphicsItemChange change, const QVariant& rValue) {
+    switch (change) {
+    case ItemPositionHasChanged:
+    case ItemTransformHasChanged:
+    case ItemRotationHasChanged:
+    case ItemScaleHasChanged:
+    case ItemTransformOriginPointHasChanged:
+    case ItemScenePositionHasChanged:
+        notifyGeometryChanged();
+        break;
+    case ItemParentHasChanged:
+        // Un sprite enfant se déplace également avec son parent : il doit alors en être informé
+        setFlag(QGraphicsItem::ItemSendsScenePositionChanges, parentItem() != nullptr);
+        notifyGeometryChanged();
+        break;
+    default:
+        break;
+    }
+    return QGraphicsPixmapItem::itemChange(change, rValue);
+}
+
+//! Invalide le rectangle global mémorisé et informe la scène que la géométrie
+//! de ce sprite a changé, afin qu'elle mette à jour son index spatial.
+void Sprite::notifyGeometryChanged() {
+    m_isGlobalBoundingRectValid = false;
+
+    if (m_pParentScene != nullptr)
+        m_pParentScene->updateSpriteGeometry(this);
+}
+
+//! Démarre ou arrête l'animation, en inscrivant ou désinscrivant le sprite auprès
+//! de la scène qui fait avancer les animations.
+//! \param isRunning  Indique si l'animation doit être en cours.
+void Sprite::setAnimationRunning(bool isRunning) {
+    if (isRunning == m_isAnimationRunning)
+        return;
+
+    m_isAnimationRunning = isRunning;
+    if (m_pParentScene == nullptr)
+        return;
+
+    if (isRunning)
+        m_pParentScene->registerSpriteForAnimation(this);
+    else
+        m_pParentScene->unregisterSpriteFromAnimation(this);
+}
+
 //! Initialise le sprite.
 void Sprite::init() {
     m_pTickHandler = nullptr;
     m_pParentScene = nullptr;
     m_emitSignalEOA = false;
     m_frameDuration = 0;
+    m_isAnimationRunning = false;
+    m_animationElapsedTime = 0;
     m_currentAnimationFrame = NO_CURRENT_FRAME;
     m_currentAnimationIndex = 0;
 
     // Par défaut, le sprite possède une (unique) liste d'animation
     addAnimation();
 
-    m_customType = -1;
-    connect(&m_animationTimer, &QTimer::timeout, this, &Sprite::onNextAnimationFrame);
+    m_capabilities = NoCapability;
+
+    // Nécessaire pour être informé des déplacements du sprite (itemChange()).
+    setFlag(QGraphicsItem::ItemSendsGeometryChanges);
+    // Un sprite enfant doit aussi être informé des déplacements de son parent.
+    // Les autres sprites n'en ont pas besoin : le flag est coûteux à chaque déplacement.
+    if (parentItem() != nullptr)
+        setFlag(QGraphicsItem::ItemSendsScenePositionChanges);
 
 #ifdef DEBUG_SPRITE_COUNT
     s_spriteCount++;
@@ -439,6 +685,7 @@ void Sprite::onNextAnimationFrame() {
     if (PreviousAnimationFrame != m_currentAnimationFrame) {
         setPixmap(m_animationList[m_currentAnimationIndex][m_currentAnimationFrame]);
         setAnimationSpeed(m_animationDurationList[m_currentAnimationIndex][m_currentAnimationFrame]);
+        notifyGeometryChanged();
         update();
     }
 }
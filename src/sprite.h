@@ -19,6 +19,9 @@
 #include <QPixmap>
 #include <QTimer>
 
+#include "TickRegistry.h"
+#include "TimerWheel.h"
+
 class GameScene;
 class SpriteTickHandler;
 
@@ -72,6 +75,12 @@ class SpriteTickHandler;
 //! La vitesse d'animation peut être réglée avec setAnimationSpeed() ou au moment
 //! de démarrer l'animation.
 //!
+//! Les images ne sont pas changées par une minuterie propre à chaque sprite : tant que
+//! l'animation est en cours, le sprite est inscrit auprès de sa scène, qui fait avancer
+//! les animations de tous ses sprites une fois par tick (advanceAnimation()), selon le
+//! temps de jeu accumulé. Un sprite qui n'est sur aucune scène ne change donc pas d'image
+//! avant d'y être ajouté.
+//!
 //! Il est également possible de demander au sprite d'émettre un signal chaque fois
 //! que l'animation est terminée, avec la méthode setEmitSignalEndOfAnimationEnabled().
 //! Cela permet par exemple de connecter ce signal au slot deleteLater() du même
@@ -101,6 +110,25 @@ class SpriteTickHandler;
 //!
 //! Avant d'être détruit, un sprite émet le signal spriteDestroyed().
 //!
+//! Un sprite qui ne se déplace jamais (décor, plateforme fixe) peut être déclaré
+//! statique avec setStatic(), de préférence avant d'être ajouté à la scène. La scène
+//! le range alors dans une structure de collision précalculée qui ne coûte rien
+//! à maintenir à chaque tick. Un sprite statique qui se déplace malgré tout redevient
+//! automatiquement dynamique.
+//!
+//! Un sprite trop éloigné de la partie affichée de la scène peut être suspendu par celle-ci
+//! (voir GameScene::activationRegion()) : il ne reçoit plus le tick et son animation s'arrête
+//! jusqu'à ce que la caméra s'en approche. Un sprite qui doit toujours rester actif, comme
+//! celui suivi par la caméra, le déclare avec setAlwaysActive().
+//!
+//! Lorsque la cadence est de durée fixe (GameCanvas::setFixedTimeStep()), le sprite n'est
+//! pas affiché à sa position simulée, mais à une position interpolée par la scène entre sa
+//! position au début du tick et sa position actuelle (voir GameScene::interpolate()).
+//! Ce décalage (renderOffset()) ne concerne que l'affichage : la position et les collisions
+//! du sprite n'en tiennent pas compte. Le rectangle de dessin du sprite (boundingRect())
+//! couvre à la fois sa position simulée et sa position affichée, alors que ses collisions
+//! se basent sur localBoundingRect(), qui ignore le décalage.
+//!
 //! \section sprite_pos Positionnement du sprite
 //! Lorsqu'un sprite est positionné sur la scène au moyen de setPos(), c'est en réalité
 //! le coin supérieur gauche du sprite qui est positionné à la coordonnée donnée.
@@ -121,6 +149,12 @@ class SpriteTickHandler;
 //!
 //! Le point de transformation peut être défini avec setTransformOriginPoint().
 //!
+//! \section sprite_capabilities Capacités du sprite
+//!
+//! Les sous-classes de Sprite déclarent leurs capacités (SpriteCapability) avec addCapability()
+//! dans leur constructeur. Le code qui doit classer un grand nombre de sprites (par exemple
+//! lors de la détection de collisions) utilise hasCapability() plutôt que dynamic_cast.
+//!
 //! \section tick_handler Le gestionnaire de cadence
 //!
 //! Un sprite peut être déplacé de plusieurs façons différents au sein d'une scène.
@@ -141,6 +175,11 @@ class SpriteTickHandler;
 //! Une dernière solution est  de spécialiser la classe Sprite afin de surcharger
 //! la méthode tick().
 //!
+//! Un sprite peut s'abonner à une phase particulière du tick (TickPhase) avec registerForTick(),
+//! par défaut à la phase physique. Pour chaque phase à laquelle il est abonné, la scène appelle
+//! phaseTick(), qui appelle tick() par défaut. Un sprite abonné à plusieurs phases surcharge
+//! phaseTick() pour savoir quelle phase est en cours.
+//!
 class Sprite : public QObject, public QGraphicsPixmapItem
 {
     Q_OBJECT
@@ -177,6 +216,10 @@ public:
     void startAnimation();
     void startAnimation(int frameDuration);
     bool isAnimationRunning() const;
+    void advanceAnimation(long long elapsedTimeInMilliseconds);
+
+    TimerWheel::TimerId scheduleAfter(int delayInMilliseconds, TimerWheel::Callback callback);
+    void cancelScheduled(TimerWheel::TimerId timerId);
 
     void showFrameFor(const QPixmap& pixmap, int durationMS);
     bool showingFrame = false;
@@ -190,7 +233,10 @@ public:
     void setEmitSignalEndOfAnimationEnabled(bool enabled);
     bool isEmitSignalEndOfAnimationEnabled() const;
 
-    QRectF globalBoundingRect() const { return mapRectToScene(boundingRect());  }
+    QRectF boundingRect() const override;
+    virtual QRectF localBoundingRect() const;
+    QRectF globalBoundingRect() const;
+    void setTransformations(const QList<QGraphicsTransform*>& rTransformations);
     QPainterPath globalShape() const { return mapToScene(shape()); }
     int width() const { return static_cast<int>(globalBoundingRect().width()); }
     int height() const { return static_cast<int>(globalBoundingRect().height()); }
@@ -198,15 +244,37 @@ public:
     int top() const { return static_cast<int>(globalBoundingRect().top()); }
     int right() const { return static_cast<int>(globalBoundingRect().right()); }
     int bottom() const { return static_cast<int>(globalBoundingRect().bottom()); }
+    virtual QRectF broadPhaseRect(long long elapsedTimeInMilliseconds) const;
 
     virtual void setParentScene(GameScene* pScene);
 
+    void setStatic(bool isStatic);
+    bool isStatic() const { return m_isStatic; }
+
+    void setAlwaysActive(bool isAlwaysActive);
+    bool isAlwaysActive() const { return m_isAlwaysActive; }
+
     enum { SpriteItemType = UserType + 1 };
     virtual int type() const override { return SpriteItemType; }
 
+    //! Capacités d'un sprite.
+    //! Elles permettent de classer un sprite sans avoir recours au RTTI (dynamic_cast),
+    //! trop coûteux dans les boucles de détection de collisions.
+    enum SpriteCapability {
+        NoCapability = 0x0,
+        AdvancedCollisionCapability = 0x1, //!< Le sprite est un AdvancedCollisionSprite.
+        PhysicsCapability = 0x2,           //!< Le sprite est un PhysicsEntity.
+        DirectionalColliderCapability = 0x4, //!< Le sprite est un DirectionalEntityCollider.
+        SelfInterpolatedCapability = 0x8     //!< Le sprite interpole lui-même son affichage (GameScene::renderProgress()).
+    };
+    int capabilities() const { return m_capabilities; }
+    bool hasCapability(SpriteCapability capability) const { return (m_capabilities & capability) != 0; }
+
     virtual void tick(long long elapsedTimeInMilliseconds);
-    void registerForTick();
+    virtual void phaseTick(TickPhase phase, long long elapsedTimeInMilliseconds);
+    void registerForTick(TickPhase phase = PhysicsPhase);
     void unregisterFromTick();
+    void unregisterFromTick(TickPhase phase);
 
     void setTickHandler(SpriteTickHandler* pTickHandler);
     SpriteTickHandler* tickHandler() const;
@@ -216,9 +284,10 @@ public:
 
     void setDebugModeEnabled(bool enabled);
 
-#ifdef QT_DEBUG
+    void setRenderOffset(const QPointF& rOffset);
+    QPointF renderOffset() const { return m_renderOffset; }
+
     virtual void paint(QPainter* pPainter, const QStyleOptionGraphicsItem* pOption, QWidget* pWidget = nullptr) override;
-#endif
 
 signals:
     void animationFinished();
@@ -233,9 +302,13 @@ signals:
     void spriteDestroyed(Sprite*);
 
 protected:
+    QVariant itemChange(GraphicsItemChange change, const QVariant& rValue) override;
+
     QList<Sprite*> collidingSprites() const;
     QList<Sprite*> collidingSprites(const QRectF& rRect) const;
     QList<Sprite*> collidingSprites(const QPainterPath& rShape) const;
+    void addCapability(SpriteCapability capability) { m_capabilities |= capability; }
+    void notifyGeometryChanged();
     GameScene* m_pParentScene;
 
 private:
@@ -243,11 +316,13 @@ private:
     static void displaySpriteCount();
 
     void init();
+    void setAnimationRunning(bool isRunning);
+    QPointF localRenderOffset() const;
 
     SpriteTickHandler* m_pTickHandler;
 
-    QTimer m_animationTimer;
-
+    bool m_isAnimationRunning;
+    long long m_animationElapsedTime; // Temps écoulé depuis l'affichage de l'image actuelle
     bool m_emitSignalEOA;
     bool m_animationStopLater = false;
 
@@ -257,7 +332,18 @@ private:
     int m_currentAnimationFrame;
     int m_currentAnimationIndex;
 
-    int m_customType;
+    int m_capabilities;
+
+    bool m_isStatic = false;
+    bool m_isAlwaysActive = false;
+
+    // Décalage de l'affichage, déterminé par la scène (interpolation entre deux ticks)
+    QPointF m_renderOffset;
+
+    // Rectangle global mémorisé, invalidé par notifyGeometryChanged()
+    mutable QRectF m_globalBoundingRect;
+    mutable QRectF m_cachedBoundingRect;
+    mutable bool m_isGlobalBoundingRectValid = false;
 
     bool m_debugMode = false;
 
@@ -5,13 +5,20 @@
 
 namespace GameFramework {
 
+    // Taille de l'écran utilisée lorsqu'aucun écran n'est disponible
+    const QSize DEFAULT_SCREEN_SIZE(1920, 1080);
+
     //! \return le rapport entre la largeur de l'écran et sa hauteur.
     double screenRatio() {
         return static_cast<double>(screenSize().width()) / screenSize().height();
     }
 
-    //! \return la taille en pixels de l'écran.
+    //! \return la taille en pixels de l'écran, ou une taille par défaut (1920 x 1080) s'il n'y a pas d'écran.
     QSize screenSize() {
+        // Sans écran (mode sans affichage, serveur), une taille par défaut est utilisée
+        if (QGuiApplication::screens().isEmpty())
+            return DEFAULT_SCREEN_SIZE;
+
         //QDesktopWidget* pDefaultScreen = QApplication::desktop();
         QScreen* pDefaultScreen = QGuiApplication::screens().first();
         QRect ScreenRect = pDefaultScreen->geometry(); // pDefaultScreen->screenGeometry();